@@ -50,6 +50,12 @@ inline constexpr bool kStackMonitoringEnabled = true;
 #else
 inline constexpr bool kStackMonitoringEnabled = false;
 #endif
+
+#if defined(CONFIG_DEBUG_PROFILE) // DEBUG_PROFILE_SCOPE
+inline constexpr bool kProfileEnabled = true;
+#else
+inline constexpr bool kProfileEnabled = false;
+#endif
 } // namespace debug::config
 
 #endif // FIRMWARE_DEBUG_DEBUG_CONFIG_H_
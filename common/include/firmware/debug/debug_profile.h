@@ -0,0 +1,146 @@
+/**
+ * @file debug_profile.h
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FIRMWARE_DEBUG_DEBUG_PROFILE_H_
+#define FIRMWARE_DEBUG_DEBUG_PROFILE_H_
+
+#include <cstdint>
+
+#include "firmware/debug/debug_config.h"
+
+#if defined(CONFIG_DEBUG_PROFILE)
+#if defined(GD32)
+#include "gd32.h"
+#else
+#include <chrono>
+#endif
+#endif
+
+/*
+ * Hot path profiling.
+ *
+ * A DEBUG_PROFILE_SCOPE records the time spent until the end of the enclosing
+ * block into the statistics of its id: count, min, max, total and a histogram
+ * with buckets of a factor 4, starting at 256 ticks.
+ * Nested scopes are inclusive.
+ *
+ * GD32 : ticks are DWT CYCCNT cycles (enabled in UdelayInit)
+ * Host : ticks are std::chrono::steady_clock nanoseconds
+ *
+ * Without CONFIG_DEBUG_PROFILE the macro expands to nothing.
+ * Only use from the super loop, the statistics are not interrupt safe.
+ */
+namespace debug::profile {
+enum class Id : uint32_t { kNetworkRun, kArtNetHandleDmx, kE131HandleDmx, kDmxNodeMerge, kPixelUpdate, kDmxSync, kUndefined };
+
+inline constexpr uint32_t kIds = static_cast<uint32_t>(Id::kUndefined);
+inline constexpr const char* kNames[kIds] = {"network", "artnet", "e131", "merge", "pixel", "dmx"};
+inline constexpr uint32_t kHistogramBuckets = 8;
+inline constexpr uint32_t kHistogramShift = 8;
+
+struct Statistics {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t histogram[kHistogramBuckets];
+};
+
+#if defined(CONFIG_DEBUG_PROFILE)
+inline Statistics s_statistics[kIds];
+
+inline uint32_t Ticks() {
+#if defined(GD32)
+    return DWT->CYCCNT;
+#else
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+inline constexpr uint32_t TicksPerSecond() {
+#if defined(GD32)
+    return MCU_CLOCK_FREQ;
+#else
+    return 1000000000U;
+#endif
+}
+
+inline void Record(Id id, uint32_t ticks) {
+    auto& statistics = s_statistics[static_cast<uint32_t>(id)];
+
+    if ((statistics.count == 0) || (ticks < statistics.min)) {
+        statistics.min = ticks;
+    }
+    if (ticks > statistics.max) {
+        statistics.max = ticks;
+    }
+
+    statistics.count++;
+    statistics.total += ticks;
+
+    const auto kHigh = ticks >> kHistogramShift;
+    auto bucket = (kHigh == 0) ? 0U : 1U + (31U - static_cast<uint32_t>(__builtin_clz(kHigh))) / 2U;
+
+    if (bucket >= kHistogramBuckets) {
+        bucket = kHistogramBuckets - 1;
+    }
+
+    statistics.histogram[bucket]++;
+}
+
+inline void Reset() {
+    for (auto& statistics : s_statistics) {
+        statistics = Statistics{};
+    }
+}
+
+inline const Statistics& Get(Id id) {
+    return s_statistics[static_cast<uint32_t>(id)];
+}
+
+class Scope {
+   public:
+    explicit Scope(Id id) : id_(id), start_(Ticks()) {}
+    ~Scope() { Record(id_, Ticks() - start_); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    Id id_;
+    uint32_t start_;
+};
+#endif
+} // namespace debug::profile
+
+#if defined(CONFIG_DEBUG_PROFILE)
+#define DEBUG_PROFILE_CONCAT_(a, b) a##b
+#define DEBUG_PROFILE_CONCAT(a, b) DEBUG_PROFILE_CONCAT_(a, b)
+#define DEBUG_PROFILE_SCOPE(id) const ::debug::profile::Scope DEBUG_PROFILE_CONCAT(profile_scope_, __LINE__)(::debug::profile::Id::id)
+#else
+#define DEBUG_PROFILE_SCOPE(id) static_cast<void>(0)
+#endif
+
+#endif // FIRMWARE_DEBUG_DEBUG_PROFILE_H_
@@ -0,0 +1,225 @@
+/**
+ * @file json_writer.h
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef JSON_JSON_WRITER_H_
+#define JSON_JSON_WRITER_H_
+
+#include <cstdint>
+#include <cassert>
+
+namespace json {
+/*
+ * Streaming JSON writer.
+ *
+ * Output goes straight into the caller supplied buffer. When the buffer is
+ * full, the flush callback is invoked with the filled part and writing
+ * restarts at the beginning of the buffer. Without a flush callback the
+ * writer behaves like a fixed buffer writer and truncates (IsOverflow).
+ *
+ * No heap, no printf. Nesting depth is limited to 32 levels.
+ */
+class Writer {
+   public:
+    using Flush = void (*)(char* buffer, uint32_t length, void* context);
+
+    Writer(char* buffer, uint32_t size, Flush flush = nullptr, void* context = nullptr) : buffer_(buffer), size_(size), flush_(flush), context_(context) {
+        assert(buffer != nullptr);
+        assert(size != 0);
+    }
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    void ObjectBegin(const char* key = nullptr) { Open(key, '{'); }
+    void ObjectEnd() { Close('}'); }
+    void ArrayBegin(const char* key = nullptr) { Open(key, '['); }
+    void ArrayEnd() { Close(']'); }
+
+    // "key":"value"
+    void Field(const char* key, const char* value) {
+        Key(key);
+        Put('"');
+        Put(value);
+        Put('"');
+    }
+
+    // "key":"c"
+    void Field(const char* key, char value) {
+        Key(key);
+        Put('"');
+        Put(value);
+        Put('"');
+    }
+
+    // "key":1234
+    void Field(const char* key, uint32_t value) {
+        Key(key);
+        PutU32(value);
+    }
+
+    // "key":"1234" - the web UI expects most counters as strings
+    void FieldQuoted(const char* key, uint32_t value) {
+        Key(key);
+        Put('"');
+        PutU32(value);
+        Put('"');
+    }
+
+    // "key":"a.b.c.d" - ip is in network byte order
+    void FieldIp(const char* key, uint32_t ip) {
+        Key(key);
+        Put('"');
+        PutIp(ip);
+        Put('"');
+    }
+
+    // Array element
+    void Value(uint32_t value) {
+        Key(nullptr);
+        PutU32(value);
+    }
+
+    // Array element
+    void Value(const char* value) {
+        Key(nullptr);
+        Put('"');
+        Put(value);
+        Put('"');
+    }
+
+    // Hands the remaining bytes to the flush callback, returns the total length
+    uint32_t Finish() {
+        assert(depth_ == 0);
+        if ((flush_ != nullptr) && (pos_ != 0)) {
+            flush_(buffer_, pos_, context_);
+            flushed_ += pos_;
+            pos_ = 0;
+        }
+        return flushed_ + pos_;
+    }
+
+    // Total number of bytes produced so far
+    uint32_t Size() const { return flushed_ + pos_; }
+
+    bool IsOverflow() const { return overflow_; }
+
+    void Put(char c) {
+        if (pos_ == size_) [[unlikely]] {
+            if (flush_ == nullptr) {
+                overflow_ = true;
+                return;
+            }
+            flush_(buffer_, pos_, context_);
+            flushed_ += pos_;
+            pos_ = 0;
+        }
+        buffer_[pos_++] = c;
+    }
+
+    void Put(const char* s) {
+        assert(s != nullptr);
+        while (*s != '\0') {
+            Put(*s++);
+        }
+    }
+
+    void PutU32(uint32_t value) {
+        char digits[10];
+        uint32_t n = 0;
+        do {
+            const auto kQ = value / 10U;
+            digits[n++] = static_cast<char>('0' + (value - kQ * 10U));
+            value = kQ;
+        } while (value != 0);
+
+        // Fast path: whole number fits in the remaining buffer
+        if ((size_ - pos_) >= n) [[likely]] {
+            while (n != 0) {
+                buffer_[pos_++] = digits[--n];
+            }
+            return;
+        }
+
+        while (n != 0) {
+            Put(digits[--n]);
+        }
+    }
+
+    void PutIp(uint32_t ip) {
+        for (uint32_t i = 0; i < 4; i++) {
+            if (i != 0) {
+                Put('.');
+            }
+            PutU32(ip & 0xFF);
+            ip >>= 8;
+        }
+    }
+
+   private:
+    void Separator() {
+        const auto kMask = 1U << depth_;
+        if ((has_items_ & kMask) != 0) {
+            Put(',');
+        }
+        has_items_ |= kMask;
+    }
+
+    void Key(const char* key) {
+        Separator();
+        if (key != nullptr) {
+            Put('"');
+            Put(key);
+            Put('"');
+            Put(':');
+        }
+    }
+
+    void Open(const char* key, char c) {
+        assert(depth_ < 31);
+        Key(key);
+        Put(c);
+        depth_++;
+        has_items_ &= ~(1U << depth_);
+    }
+
+    void Close(char c) {
+        assert(depth_ != 0);
+        depth_--;
+        Put(c);
+    }
+
+    char* buffer_;
+    uint32_t size_;
+    Flush flush_;
+    void* context_;
+    uint32_t pos_{0};
+    uint32_t flushed_{0};
+    uint32_t has_items_{0};
+    uint32_t depth_{0};
+    bool overflow_{false};
+};
+} // namespace json
+
+#endif // JSON_JSON_WRITER_H_
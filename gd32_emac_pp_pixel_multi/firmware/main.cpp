@@ -78,7 +78,7 @@ int main() // NOLINT
 
     const auto kActivePorts = pixeldmx_multi.GetOutputPorts();
 
-    pp.SetCount(pixeldmx_multi.GetGroups(), kActivePorts, false);
+    pp.SetCount(pixeldmx_multi.GetGroups(), kActivePorts, true);
 
     const auto kTestPattern = pixeltest_pattern.GetPattern();
 
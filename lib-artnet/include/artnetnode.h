@@ -138,6 +138,16 @@ struct OutputPort {
     bool is_data_pending;
 };
 
+#if defined(CONFIG_ARTNET_OPCODE_STATS)
+inline constexpr uint32_t kOpStatsBuckets = 8; ///< Handler time 0, 1, 2-3, 4-7 .. 32-63, >= 64 us
+
+struct OpStats {
+    uint32_t received;
+    uint32_t too_short;
+    uint32_t micros[kOpStatsBuckets];
+};
+#endif
+
 struct InputPort {
     uint32_t destination_ip;
     uint32_t millis;
@@ -315,6 +325,8 @@ class ArtNetNode {
     void SendDiag(artnet::PriorityCodes kPriorityCode, const char* format, ...);
 
     void HandlePoll();
+    void HandleOpDmx();
+    void HandleOpSync();
     void HandleDmx();
     void HandleSync();
     void HandleAddress();
@@ -347,14 +359,48 @@ class ArtNetNode {
 
     void FailSafeRecord();
     void FailSafePlayback();
+    void FailSafePlaybackRun();
 
     void InputUdp(const uint8_t* buffer, uint32_t size, uint32_t from_ip, uint16_t from_port);
 
+    /*
+     * Op-code dispatch table. All implemented op-codes have a zero low byte,
+     * so the high byte indexes kOpIndex, which holds the kOpHandlers entry.
+     */
+    struct OpHandler {
+        void (ArtNetNode::*handler)();
+        uint16_t op_code;
+        uint16_t min_length;
+        uint8_t flags;
+    };
+
+    static constexpr uint32_t kOpHandlersMax = 16;
+    static constexpr uint8_t kOpFlagOutput = (1U << 0); ///< Requires an output type
+    static constexpr uint8_t kOpFlagRdm = (1U << 1);    ///< Requires RDM enabled
+    struct OpIndex {
+        uint8_t entry[256];
+    };
+
+    static const OpHandler kOpHandlers[];
+    static const OpIndex kOpIndex;
+
+#if defined(CONFIG_ARTNET_OPCODE_STATS)
+   public:
+    const artnetnode::OpStats& GetOpStats(uint32_t index) const { return op_stats_[index]; }
+    void PrintOpStats();
+
+   private:
+    artnetnode::OpStats op_stats_[kOpHandlersMax];
+#endif
+
     int32_t handle_{-1};
     uint32_t ip_address_from_;
     uint32_t current_millis_{0};
     uint32_t packet_millis_{0};
     uint8_t* receive_buffer_{nullptr};
+#if defined(ARTNET_HAVE_FAILSAFE_RECORD)
+    uint32_t failsafe_playback_port_index_{dmxnode::kMaxPorts};
+#endif
 
     DmxNodeOutputType* dmxnode_output_type_{nullptr};
 
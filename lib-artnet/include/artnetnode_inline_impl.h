@@ -265,6 +265,12 @@ inline void ArtNetNode::Run() {
         SetNetworkDataLossCondition();
     }
 
+#if defined(ARTNET_HAVE_FAILSAFE_RECORD)
+    if (failsafe_playback_port_index_ < dmxnode::kMaxPorts) [[unlikely]] {
+        FailSafePlaybackRun();
+    }
+#endif
+
     if (kDeltaMillis >= (1U * 1000U)) {
         state_.receiving_dmx &= static_cast<uint8_t>(~(1U << static_cast<uint8_t>(dmxnode::Direction::kOutput)));
     }
@@ -24,6 +24,7 @@
  */
 
 #include <cstdint>
+#include <cstddef>
 #include <cstdio>
 #include <cstring>
 #include <utility>
@@ -62,6 +63,7 @@
 #include "timing.h"
 #include "board.h"
 #include "board_statusled.h"
+#include "firmware/debug/debug_profile.h"
 #include "artnet_debug.h"
 
 #if defined(ARTNET_SHOWFILE)
@@ -73,6 +75,15 @@ void Record(const struct artnet::ArtSync* artsync, uint32_t millis);
 
 static constexpr auto kArtnetMinHeaderSize = 12U;
 
+// Only ArtDmx is handled in the EMAC receive buffer, all other OpCodes may reply in place
+static bool IsZeroCopy(const uint8_t* buffer, uint32_t size) {
+    if (size < kArtnetMinHeaderSize) {
+        return false;
+    }
+
+    return ((static_cast<uint16_t>(buffer[9] << 8)) + buffer[8]) == std::to_underlying(artnet::OpCodes::kOpDmx);
+}
+
 ArtNetNode::ArtNetNode() {
     ARTNET_DEBUG_ENTRY();
 
@@ -190,7 +201,7 @@ void ArtNetNode::Start() {
     art_poll_reply_.status3 |= artnet::Status3::kSupportsLlrp;
 #endif
 
-    handle_ = network::udp::Begin(artnet::kUdpPort, StaticCallbackFunction);
+    handle_ = network::udp::Begin(artnet::kUdpPort, StaticCallbackFunction, IsZeroCopy);
     assert(handle_ != -1);
 
 #if defined(RDM_CONTROLLER)
@@ -739,6 +750,103 @@ static artnet::OpCodes GetOpCode(uint32_t bytes_received, const uint8_t* buffer)
     return artnet::OpCodes::kOpNotDefined;
 }
 
+#if (DMXNODE_PORTS > 0)
+void ArtNetNode::HandleOpDmx() {
+    HandleDmx();
+    state_.art.dmx_ip = ip_address_from_;
+#if defined(ARTNET_SHOWFILE)
+    if (state_.do_record) {
+        showfile::Record(reinterpret_cast<const artnet::ArtDmx*>(receive_buffer_), current_millis_);
+    }
+#endif
+}
+
+void ArtNetNode::HandleOpSync() {
+    /*
+     * In order to allow for multiple controllers on a network,
+     * a node shall compare the source IP of the ArtSync to the source IP
+     * of the most recent ArtDmx packet.
+     * The ArtSync shall be ignored if the IP addresses do not match.
+     */
+    /*
+     * When a port is merging multiple streams of ArtDmx from different IP addresses,
+     * ArtSync packets shall be ignored.
+     */
+    if ((state_.art.dmx_ip == ip_address_from_) && (!state_.is_merge_mode)) {
+        state_.art.sync_millis = current_millis_;
+        HandleSync();
+    }
+#if defined(ARTNET_SHOWFILE)
+    if (state_.do_record) {
+        showfile::Record(reinterpret_cast<const artnet::ArtSync*>(receive_buffer_), current_millis_);
+    }
+#endif
+}
+#endif
+
+#if defined(ARTNET_HAVE_TIMECODE)
+void ArtNetNode::HandleTimeCode() {
+    const auto* const kArtTimeCode = reinterpret_cast<const artnet::ArtTimeCode*>(receive_buffer_);
+    art_time_code_callback_function_ptr_(reinterpret_cast<const struct artnet::TimeCode*>(&kArtTimeCode->frames));
+}
+#endif
+
+#if defined(ARTNET_HAVE_TRIGGER)
+void ArtNetNode::HandleTrigger() {
+    const auto* const kArtTrigger = reinterpret_cast<const artnet::ArtTrigger*>(receive_buffer_);
+    if ((kArtTrigger->oem_code_hi == 0xFF && kArtTrigger->oem_code_lo == 0xFF) || (kArtTrigger->oem_code_hi == ArtNetConst::kOemId[0] && kArtTrigger->oem_code_lo == ArtNetConst::kOemId[1])) {
+        ARTNET_DEBUG_PRINTF("Key=%d, SubKey=%d, Data[0]=%d", kArtTrigger->key, kArtTrigger->sub_key, kArtTrigger->data[0]);
+        art_trigger_callback_function_ptr_(reinterpret_cast<const struct ArtNetTrigger*>(&kArtTrigger->key));
+    }
+}
+#endif
+
+/*
+ * Entry 0 is the 'not implemented' entry.
+ * The minimum length covers the fixed part of the packet, the handlers do not check the size.
+ */
+constexpr ArtNetNode::OpHandler ArtNetNode::kOpHandlers[] = {
+    {nullptr, static_cast<uint16_t>(artnet::OpCodes::kOpNotDefined), 0, 0},
+#if (DMXNODE_PORTS > 0)
+    {&ArtNetNode::HandleOpDmx, static_cast<uint16_t>(artnet::OpCodes::kOpDmx), offsetof(artnet::ArtDmx, data), kOpFlagOutput},
+    {&ArtNetNode::HandleOpSync, static_cast<uint16_t>(artnet::OpCodes::kOpSync), sizeof(artnet::ArtSync), kOpFlagOutput},
+#endif
+    {&ArtNetNode::HandlePoll, static_cast<uint16_t>(artnet::OpCodes::kOpPoll), offsetof(artnet::ArtPoll, target_port_address_top_hi), 0},
+    {&ArtNetNode::HandleAddress, static_cast<uint16_t>(artnet::OpCodes::kOpAddress), sizeof(artnet::ArtAddress), 0},
+#if defined(ARTNET_HAVE_TIMECODE)
+    {&ArtNetNode::HandleTimeCode, static_cast<uint16_t>(artnet::OpCodes::kOpTimecode), sizeof(artnet::ArtTimeCode), 0},
+#endif
+#if !defined(DISABLE_RTC)
+    {&ArtNetNode::HandleTimeSync, static_cast<uint16_t>(artnet::OpCodes::kOpTimesync), sizeof(artnet::ArtTimeSync), 0},
+#endif
+#if defined(RDM_CONTROLLER) || defined(RDM_RESPONDER)
+    {&ArtNetNode::HandleTodRequest, static_cast<uint16_t>(artnet::OpCodes::kOpTodrequest), offsetof(artnet::ArtTodRequest, address), kOpFlagRdm},
+    {&ArtNetNode::HandleTodData, static_cast<uint16_t>(artnet::OpCodes::kOpToddata), offsetof(artnet::ArtTodData, tod), kOpFlagRdm},
+    {&ArtNetNode::HandleTodControl, static_cast<uint16_t>(artnet::OpCodes::kOpTodcontrol), sizeof(artnet::ArtTodControl), kOpFlagRdm},
+    {&ArtNetNode::HandleRdm, static_cast<uint16_t>(artnet::OpCodes::kOpRdm), offsetof(artnet::ArtRdm, rdm_packet), kOpFlagRdm},
+    {&ArtNetNode::HandleRdmSub, static_cast<uint16_t>(artnet::OpCodes::kOpRdmsub), offsetof(artnet::ArtRdmSub, data), kOpFlagRdm},
+#endif
+    // Legacy controllers end the packet after the subnet mask
+    {&ArtNetNode::HandleIpProg, static_cast<uint16_t>(artnet::OpCodes::kOpIpprog), offsetof(artnet::ArtIpProg, prog_port_hi), 0},
+#if defined(ARTNET_HAVE_TRIGGER)
+    {&ArtNetNode::HandleTrigger, static_cast<uint16_t>(artnet::OpCodes::kOpTrigger), offsetof(artnet::ArtTrigger, data), 0},
+#endif
+#if defined(ARTNET_HAVE_DMXIN)
+    {&ArtNetNode::HandleInput, static_cast<uint16_t>(artnet::OpCodes::kOpInput), sizeof(artnet::ArtInput), 0},
+#endif
+};
+
+constexpr ArtNetNode::OpIndex ArtNetNode::kOpIndex = [] {
+    static_assert(sizeof(kOpHandlers) / sizeof(kOpHandlers[0]) <= kOpHandlersMax);
+    OpIndex index{};
+
+    for (uint32_t i = 1; i < sizeof(kOpHandlers) / sizeof(kOpHandlers[0]); i++) {
+        index.entry[kOpHandlers[i].op_code >> 8] = static_cast<uint8_t>(i);
+    }
+
+    return index;
+}();
+
 void ArtNetNode::InputUdp(const uint8_t* buffer, uint32_t size, uint32_t from_ip, [[maybe_unused]] uint16_t from_port) {
     const auto kOpCode = GetOpCode(size, buffer);
 
@@ -758,112 +866,63 @@ void ArtNetNode::InputUdp(const uint8_t* buffer, uint32_t size, uint32_t from_ip
         }
     }
 
-    switch (kOpCode) {
-#if (DMXNODE_PORTS > 0)
-        case artnet::OpCodes::kOpDmx:
-            if (dmxnode_output_type_ != nullptr) {
-                HandleDmx();
-                state_.art.dmx_ip = ip_address_from_;
-#if defined(ARTNET_SHOWFILE)
-                if (state_.do_record) {
-                    showfile::Record(reinterpret_cast<const artnet::ArtDmx*>(buffer), current_millis_);
-                }
-#endif
-            }
-            break;
-        case artnet::OpCodes::kOpSync:
-            if (dmxnode_output_type_ != nullptr) {
-                /*
-                 * In order to allow for multiple controllers on a network,
-                 * a node shall compare the source IP of the ArtSync to the source IP
-                 * of the most recent ArtDmx packet.
-                 * The ArtSync shall be ignored if the IP addresses do not match.
-                 */
-                /*
-                 * When a port is merging multiple streams of ArtDmx from different IP addresses,
-                 * ArtSync packets shall be ignored.
-                 */
-                if ((state_.art.dmx_ip == ip_address_from_) && (!state_.is_merge_mode)) {
-                    state_.art.sync_millis = current_millis_;
-                    HandleSync();
-                }
-#if defined(ARTNET_SHOWFILE)
-                if (state_.do_record) {
-                    showfile::Record(reinterpret_cast<const artnet::ArtSync*>(buffer), current_millis_);
-                }
-#endif
-            }
-            break;
-#endif
-        case artnet::OpCodes::kOpAddress:
-            HandleAddress();
-            break;
-#if defined(ARTNET_HAVE_TIMECODE)
-        case artnet::OpCodes::kOpTimecode: {
-            const auto* const kArtTimeCode = reinterpret_cast<const artnet::ArtTimeCode*>(buffer);
-            art_time_code_callback_function_ptr_(reinterpret_cast<const struct artnet::TimeCode*>(&kArtTimeCode->frames));
-        } break;
-#endif
-#if !defined(DISABLE_RTC)
-        case artnet::OpCodes::kOpTimesync:
-            HandleTimeSync();
-            break;
+    panelled::On(panelled::kArtnet);
+
+    const auto kIndex = kOpIndex.entry[static_cast<uint16_t>(kOpCode) >> 8];
+    const auto& kOpHandler = kOpHandlers[kIndex];
+
+    // ArtNet but op_code is not implemented, just skip ... no error
+    if (__builtin_expect((kOpHandler.op_code != static_cast<uint16_t>(kOpCode)), 0)) {
+        return;
+    }
+
+#if defined(CONFIG_ARTNET_OPCODE_STATS)
+    auto& op_stats = op_stats_[kIndex];
+    op_stats.received++;
 #endif
-#if defined(RDM_CONTROLLER) || defined(RDM_RESPONDER)
-        case artnet::OpCodes::kOpTodrequest:
-            if (state_.is_rdm_enabled) {
-                HandleTodRequest();
-            }
-            break;
-        case artnet::OpCodes::kOpToddata:
-            if (state_.is_rdm_enabled) {
-                HandleTodData();
-            }
-            break;
-        case artnet::OpCodes::kOpTodcontrol:
-            if (state_.is_rdm_enabled) {
-                HandleTodControl();
-            }
-            break;
-        case artnet::OpCodes::kOpRdm:
-            if (state_.is_rdm_enabled) {
-                HandleRdm();
-            }
-            break;
-        case artnet::OpCodes::kOpRdmsub:
-            if (state_.is_rdm_enabled) {
-                HandleRdmSub();
-            }
-            break;
+
+    if (__builtin_expect((size < kOpHandler.min_length), 0)) {
+#if defined(CONFIG_ARTNET_OPCODE_STATS)
+        op_stats.too_short++;
 #endif
-        case artnet::OpCodes::kOpIpprog:
-            HandleIpProg();
-            break;
-#if defined(ARTNET_HAVE_TRIGGER)
-        case artnet::OpCodes::kOpTrigger: {
-            const auto* const kArtTrigger = reinterpret_cast<const artnet::ArtTrigger*>(buffer);
-            if ((kArtTrigger->oem_code_hi == 0xFF && kArtTrigger->oem_code_lo == 0xFF) || (kArtTrigger->oem_code_hi == ArtNetConst::kOemId[0] && kArtTrigger->oem_code_lo == ArtNetConst::kOemId[1])) {
-                ARTNET_DEBUG_PRINTF("Key=%d, SubKey=%d, Data[0]=%d", kArtTrigger->key, kArtTrigger->sub_key, kArtTrigger->data[0]);
-                art_trigger_callback_function_ptr_(reinterpret_cast<const struct ArtNetTrigger*>(&kArtTrigger->key));
-            }
-        } break;
+        return;
+    }
+
+    if (((kOpHandler.flags & kOpFlagOutput) != 0) && (dmxnode_output_type_ == nullptr)) {
+        return;
+    }
+
+    if (((kOpHandler.flags & kOpFlagRdm) != 0) && (!state_.is_rdm_enabled)) {
+        return;
+    }
+
+#if defined(CONFIG_ARTNET_OPCODE_STATS)
+    const auto kMicros = timing::Micros();
 #endif
-#if defined(ARTNET_HAVE_DMXIN)
-        case artnet::OpCodes::kOpInput:
-            HandleInput();
-            break;
+
+    (this->*kOpHandler.handler)();
+
+#if defined(CONFIG_ARTNET_OPCODE_STATS)
+    const auto kElapsed = timing::Micros() - kMicros;
+    const auto kBucket = (kElapsed == 0) ? 0U : static_cast<uint32_t>(32 - __builtin_clz(kElapsed));
+    op_stats.micros[kBucket < artnetnode::kOpStatsBuckets ? kBucket : artnetnode::kOpStatsBuckets - 1]++;
 #endif
-        case artnet::OpCodes::kOpPoll:
-            HandlePoll();
-            break;
-        default:
-            // ArtNet but op_code is not implemented
-            // Just skip ... no error
-            break;
-    }
+}
 
-    panelled::On(panelled::kArtnet);
+#if defined(CONFIG_ARTNET_OPCODE_STATS)
+void ArtNetNode::PrintOpStats() {
+    puts("Art-Net op-codes");
+
+    for (uint32_t i = 1; i < sizeof(kOpHandlers) / sizeof(kOpHandlers[0]); i++) {
+        const auto& kOpStats = op_stats_[i];
+        printf(" 0x%04x %u %u |", kOpHandlers[i].op_code, static_cast<unsigned int>(kOpStats.received), static_cast<unsigned int>(kOpStats.too_short));
+        for (uint32_t bucket = 0; bucket < artnetnode::kOpStatsBuckets; bucket++) {
+            printf(" %u", static_cast<unsigned int>(kOpStats.micros[bucket]));
+        }
+        puts("");
+    }
 }
+#endif
 
 void ArtNetNode::UpdateMergeStatus(uint32_t port_index) {
     if (!state_.is_merge_mode) {
@@ -903,6 +962,7 @@ void ArtNetNode::CheckMergeTimeouts(uint32_t port_index) {
 }
 
 void ArtNetNode::HandleDmx() {
+    DEBUG_PROFILE_SCOPE(kArtNetHandleDmx);
     const auto* const kArtDmx = reinterpret_cast<artnet::ArtDmx*>(receive_buffer_);
 
     for (uint32_t port_index = 0; port_index < dmxnode::kMaxPorts; port_index++) {
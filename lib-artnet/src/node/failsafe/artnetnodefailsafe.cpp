@@ -2,7 +2,7 @@
  * @file artnetnodefailsafe.cpp
  *
  */
-/* Copyright (C) 2022-2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2022-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -24,6 +24,7 @@
  */
 
 #include <cstdint>
+#include <cstring>
 
 #include "artnetnode.h"
 #include "dmxnode.h"
@@ -47,26 +48,49 @@ void ArtNetNode::FailSafeRecord() {
     DEBUG_EXIT();
 }
 
+/*
+ * The playback is progressive: one port is restored per Run() pass, so the
+ * super loop keeps running and the first port is lit without waiting for
+ * the others.
+ */
 void ArtNetNode::FailSafePlayback() {
     DEBUG_ENTRY();
 
     dmxnode::scenes::ReadStart();
+    failsafe_playback_port_index_ = 0;
 
-    for (uint32_t port_index = 0; port_index < dmxnode::kMaxPorts; port_index++) {
-        if (node_.port[port_index].direction == dmxnode::Direction::kOutput) {
-            dmxnode::scenes::Read(port_index, const_cast<uint8_t*>(dmxnode::Data::Backup(port_index)));
-            dmxnode::DataOutput(dmxnode_output_type_, port_index);
+    DEBUG_EXIT();
+}
 
-            if (!output_port_[port_index].is_transmitting) {
-                dmxnode_output_type_->Start(port_index);
-                output_port_[port_index].is_transmitting = true;
-            }
+void ArtNetNode::FailSafePlaybackRun() {
+    auto port_index = failsafe_playback_port_index_;
 
-            dmxnode::Data::ClearLength(port_index);
-        }
+    // Find the next output port
+    while ((port_index < dmxnode::kMaxPorts) && (node_.port[port_index].direction != dmxnode::Direction::kOutput)) {
+        port_index++;
     }
 
-    dmxnode::scenes::ReadEnd();
+    // Data is received again, or all ports are restored
+    if ((port_index == dmxnode::kMaxPorts) || ((current_millis_ - packet_millis_) < (artnet::kNetworkDataLossTimeout * 1000))) {
+        dmxnode::scenes::ReadEnd();
+        failsafe_playback_port_index_ = dmxnode::kMaxPorts;
+        return;
+    }
 
-    DEBUG_EXIT();
+    // As source A, the data of a direct source is kept before the output is overwritten
+    uint8_t data[dmxnode::kUniverseSize] __attribute__((aligned(4)));
+    memcpy(data, dmxnode::Data::Backup(port_index), dmxnode::kUniverseSize);
+
+    dmxnode::scenes::Read(port_index, data);
+    dmxnode::Data::SetSourceA(port_index, data, dmxnode::kUniverseSize);
+    dmxnode::DataOutput(dmxnode_output_type_, port_index);
+
+    if (!output_port_[port_index].is_transmitting) {
+        dmxnode_output_type_->Start(port_index);
+        output_port_[port_index].is_transmitting = true;
+    }
+
+    dmxnode::Data::ClearLength(port_index);
+
+    failsafe_playback_port_index_ = port_index + 1;
 }
@@ -241,6 +241,8 @@ inline constexpr uint32_t kMaxUniverses = 16;
 struct Flags {
     enum class Flag : uint32_t {
         kEnableGamma = (1U << 0),
+        kInput16Bit = (1U << 1),
+        kDithering = (1U << 2),
     };
 
     static constexpr bool Has(uint32_t value, Flag flag) noexcept { return (value & static_cast<uint32_t>(flag)) != 0; }
@@ -62,6 +62,13 @@ inline constexpr uint8_t STORAGE = 0x08;
 inline constexpr uint8_t TIME = 0x10;
 } // namespace flags1
 
+namespace flags2
+{
+inline constexpr uint8_t SEQUENCE_MASK = 0x0f; ///< 1-15, 0 = not used
+} // namespace flags2
+
+inline constexpr uint32_t TIMECODE_LEN = 4; ///< Follows the header when flags1::TIME is set
+
 namespace id
 {
 inline constexpr uint8_t DISPLAY = 1;
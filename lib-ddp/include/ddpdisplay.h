@@ -104,7 +104,8 @@ class DdpDisplay
    private:
     void CalculateOffsets();
     void HandleQuery();
-    void HandleData();
+    void HandleData(uint32_t size);
+    bool IsLate(uint32_t sequence);
 
     void static StaticCallbackFunction(const uint8_t* buffer, uint32_t size, uint32_t from_ip, uint16_t from_port)
     {
@@ -119,13 +120,20 @@ class DdpDisplay
     uint32_t strip_data_length_{0};
     uint32_t dmxnode_output_type_data_max_length_{0};
     uint32_t active_ports_{0};
+    uint32_t sequence_{0}; ///< Sequence number of the frame being assembled, 0 = not used
+    bool is_pushed_{false};
 
     DmxNodeOutputType* dmxnode_output_type_{nullptr};
 
     uint8_t mac_address_[network::iface::kMacSize];
 
-    static inline uint32_t s_port_length[ddpdisplay::lightset::kMaxPorts];
-    static inline uint32_t s_offset_compare[ddpdisplay::configuration::kMaxPorts];
+    /*
+     * The DDP data offset of each lightset port, the last entry is the end of the data.
+     * A pixel port spans 4 lightset ports, unused ones have a zero length.
+     */
+    static inline uint32_t s_port_begin[ddpdisplay::lightset::kMaxPorts + 1];
+    static inline uint16_t s_port_length[ddpdisplay::lightset::kMaxPorts];
+    static inline uint32_t s_port_received[(ddpdisplay::lightset::kMaxPorts + 31) / 32];
     static inline DdpDisplay* s_this;
 };
 
@@ -24,12 +24,13 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <algorithm>
 #include <cassert>
 
 #include "ddpdisplay.h"
 #include "ddp.h"
 #include "dmxnodedata.h"
-#include "dmxnode_data.h"
 #include "apps/mdns.h"
 #include "network_iface.h"
 #include "network_udp.h"
@@ -94,11 +95,23 @@ DdpDisplay::~DdpDisplay() {
 }
 
 void DdpDisplay::CalculateOffsets() {
-    uint32_t sum = 0;
+    uint32_t port_index = 0;
+    uint32_t begin = 0;
 
     for (uint32_t pixel_port_index = 0; pixel_port_index < ddpdisplay::configuration::pixel::kMaxPorts; pixel_port_index++) {
-        sum = sum + strip_data_length_;
-        s_offset_compare[pixel_port_index] = sum;
+        const auto kStripBegin = begin;
+        auto remaining = strip_data_length_;
+
+        for (uint32_t universe = 0; universe < 4; universe++) {
+            const auto kLength = std::min(remaining, dmxnode_output_type_data_max_length_);
+            s_port_begin[port_index] = begin;
+            s_port_length[port_index] = static_cast<uint16_t>(kLength);
+            begin += kLength;
+            remaining -= kLength;
+            port_index++;
+        }
+
+        begin = kStripBegin + strip_data_length_;
     }
 
     /*
@@ -112,14 +125,18 @@ void DdpDisplay::CalculateOffsets() {
 #endif
 
     for (uint32_t dmx_port_index = 0; dmx_port_index < ddpdisplay::configuration::dmx::kMaxPorts; dmx_port_index++) {
-        sum = sum + dmxnode::kUniverseSize;
-        const auto kIndexOffset = dmx_port_index + ddpdisplay::configuration::pixel::kMaxPorts;
-        s_offset_compare[kIndexOffset] = sum;
+        s_port_begin[port_index] = begin;
+        s_port_length[port_index] = static_cast<uint16_t>(dmxnode::kUniverseSize);
+        begin += dmxnode::kUniverseSize;
+        port_index++;
     }
 
 #if __GNUC__ < 10
 #pragma GCC diagnostic pop
 #endif
+
+    assert(port_index == ddpdisplay::lightset::kMaxPorts);
+    s_port_begin[port_index] = begin;
 }
 
 void DdpDisplay::Start() {
@@ -172,7 +189,7 @@ void DdpDisplay::HandleQuery() {
         packet->header.len[0] = static_cast<uint8_t>(kLength >> 8);
         packet->header.len[1] = static_cast<uint8_t>(kLength);
 
-        network::udp::Send(handle_, reinterpret_cast<const uint8_t*>(&packet), (ddp::HEADER_LEN + static_cast<uint16_t>(kLength)), network::GetPrimaryIp() | ~(network::GetNetmask()), ddp::kUdpPort);
+        network::udp::Send(handle_, reinterpret_cast<const uint8_t*>(packet), (ddp::HEADER_LEN + static_cast<uint16_t>(kLength)), network::GetPrimaryIp() | ~(network::GetNetmask()), ddp::kUdpPort);
     }
 
     if ((packet->header.id & ddp::id::STATUS) == ddp::id::CONFIG) {
@@ -194,87 +211,136 @@ void DdpDisplay::HandleQuery() {
         packet->header.len[0] = static_cast<uint8_t>(kLength >> 8);
         packet->header.len[1] = static_cast<uint8_t>(kLength);
 
-        network::udp::Send(handle_, reinterpret_cast<const uint8_t*>(&packet), ddp::HEADER_LEN + kLength, from_ip_, ddp::kUdpPort);
+        network::udp::Send(handle_, reinterpret_cast<const uint8_t*>(packet), ddp::HEADER_LEN + kLength, from_ip_, ddp::kUdpPort);
 
-        debug::Dump(&packet, ddp::HEADER_LEN + kLength);
+        debug::Dump(packet, ddp::HEADER_LEN + kLength);
     }
 
     DEBUG_EXIT();
 }
 
-void DdpDisplay::HandleData() {
-    const auto* const kPacket = reinterpret_cast<ddp::Packet*>(receive_buffer_);
-    auto offset = static_cast<uint32_t>((kPacket->header.offset[0] << 24) | (kPacket->header.offset[1] << 16) | (kPacket->header.offset[2] << 8) | kPacket->header.offset[3]);
-    auto length = ((static_cast<uint32_t>(kPacket->header.len[0]) << 8) | kPacket->header.len[1]);
-    const auto* const kReceivedData = kPacket->data;
+/*
+ * The sequence number is per frame. A packet from a frame that is already pushed,
+ * or older than the frame being assembled, arrived late and is dropped.
+ */
+bool DdpDisplay::IsLate(uint32_t sequence) {
+    if (sequence == 0) {
+        return false;
+    }
 
-    uint32_t data_source_index = 0;
-    uint32_t receiver_buffer_index = 0;
+    if (sequence_ != 0) {
+        if (sequence == sequence_) {
+            return is_pushed_;
+        }
 
-    for (uint32_t port_index = 0; (port_index < active_ports_) && (length != 0); port_index++) {
-        data_source_index = port_index * 4;
+        // 1-15, newer when ahead by at most half the range
+        const auto kDistance = (sequence + 15U - sequence_) % 15U;
 
-        const auto kOutportIndexEnd = data_source_index + 4;
+        if (kDistance > 7U) {
+            return true;
+        }
+    }
 
-        while ((offset < s_offset_compare[port_index]) && (data_source_index < kOutportIndexEnd)) {
-            const auto kOutLength = std::min(std::min(length, dmxnode_output_type_data_max_length_), strip_data_length_);
+    sequence_ = sequence;
+    is_pushed_ = false;
 
-            dmxnode::Data::SetSourceA(data_source_index, &kReceivedData[receiver_buffer_index], kOutLength);
-            s_port_length[data_source_index] = kOutLength;
+    return false;
+}
 
-            receiver_buffer_index += kOutLength;
-            offset += kOutLength;
-            length -= kOutLength;
-            data_source_index++;
-        }
+void DdpDisplay::HandleData(uint32_t size) {
+    const auto* const kPacket = reinterpret_cast<ddp::Packet*>(receive_buffer_);
+
+    if (IsLate(kPacket->header.flags2 & ddp::flags2::SEQUENCE_MASK)) {
+        DEBUG_PUTS("Late packet");
+        return;
     }
 
-    /*
-     * 2x DMX ports
-     */
+    auto offset = static_cast<uint32_t>((kPacket->header.offset[0] << 24) | (kPacket->header.offset[1] << 16) | (kPacket->header.offset[2] << 8) | kPacket->header.offset[3]);
+    auto length = ((static_cast<uint32_t>(kPacket->header.len[0]) << 8) | kPacket->header.len[1]);
+    const auto* received_data = kPacket->data;
+    auto data_length = size - ddp::HEADER_LEN;
 
-    data_source_index = ddpdisplay::lightset::kMaxPorts - ddpdisplay::configuration::dmx::kMaxPorts;
+    if ((kPacket->header.flags1 & ddp::flags1::TIME) == ddp::flags1::TIME) {
+        if (data_length < ddp::TIMECODE_LEN) {
+            return;
+        }
+        received_data += ddp::TIMECODE_LEN;
+        data_length -= ddp::TIMECODE_LEN;
+    }
 
-    DEBUG_PRINTF("nLightSetPortIndex=%u", data_source_index);
+    length = std::min(length, data_length);
 
-    for (uint32_t port_index = ddpdisplay::configuration::pixel::kMaxPorts; (port_index < ddpdisplay::configuration::kMaxPorts) && (length != 0); port_index++) {
-        if (offset < s_offset_compare[port_index]) {
-            const auto kLength = std::min(length, dmxnode::kUniverseSize);
+    if (offset < s_port_begin[ddpdisplay::lightset::kMaxPorts]) {
+        // Binary search for the last port starting at or before the offset, this skips the ports with a zero length
+        uint32_t port_index = 0;
+        uint32_t high = ddpdisplay::lightset::kMaxPorts;
 
-            //			DEBUG_PRINTF("==> nPortIndex=%u, nOffset=%u, nLength=%u, nLightSetLength=%u, nLightSetPortIndex=%u", nPortIndex, nOffset, nLength,
-            // nLightSetLength, nLightSetPortIndex);
+        while ((high - port_index) > 1) {
+            const auto kMiddle = (port_index + high) / 2;
+            if (s_port_begin[kMiddle] <= offset) {
+                port_index = kMiddle;
+            } else {
+                high = kMiddle;
+            }
+        }
+
+        while ((length != 0) && (port_index < ddpdisplay::lightset::kMaxPorts)) {
+            const auto kSlot = offset - s_port_begin[port_index];
+            const auto kSpan = std::min(length, s_port_begin[port_index + 1] - offset);
+            const auto kIsActive = (port_index >= (ddpdisplay::configuration::pixel::kMaxPorts * 4)) || ((port_index / 4) < active_ports_);
 
-            dmxnode::Data::SetSourceA(port_index, &kReceivedData[receiver_buffer_index], kLength);
-            s_port_length[port_index] = kLength;
+            if (kIsActive && (kSlot < s_port_length[port_index])) {
+                dmxnode::Data::SetSlotsA(port_index, kSlot, received_data, std::min(kSpan, s_port_length[port_index] - kSlot));
+                s_port_received[port_index / 32] |= (1U << (port_index & 31));
+            }
 
-            receiver_buffer_index += kLength;
-            offset += kLength;
-            length -= kLength;
+            received_data += kSpan;
+            offset += kSpan;
+            length -= kSpan;
             port_index++;
+        }
+    }
 
-            //			DEBUG_PRINTF("nPortIndex=%u, nOffset=%u, nLength=%u, nLightSetLength=%u, nLightSetPortIndex=%u", nPortIndex, nOffset, nLength,
-            // nLightSetLength, nLightSetPortIndex);
+    if ((kPacket->header.flags1 & ddp::flags1::PUSH) != ddp::flags1::PUSH) {
+        return;
+    }
+
+    /*
+     * Only the ports received in this frame are converted, followed by a single update.
+     */
+    for (uint32_t index = 0; index < sizeof(s_port_received) / sizeof(s_port_received[0]); index++) {
+        for (auto received = s_port_received[index]; received != 0; received &= received - 1U) {
+            const auto kPortIndex = index * 32 + static_cast<uint32_t>(__builtin_ctz(received));
+            dmxnode_output_type_->SetData<false>(kPortIndex, dmxnode::Data::Backup(kPortIndex), dmxnode::Data::GetLength(kPortIndex));
+            dmxnode_output_type_->Sync(kPortIndex);
         }
     }
 
-    if ((kPacket->header.flags1 & ddp::flags1::PUSH) == ddp::flags1::PUSH) {
-        for (uint32_t data_output_port_index = 0; data_output_port_index < ddpdisplay::lightset::kMaxPorts; data_output_port_index++) {
-            dmxnode::DataOutput(dmxnode_output_type_, data_output_port_index);
-            dmxnode::Data::ClearLength(data_output_port_index);
+    dmxnode_output_type_->Sync();
+
+    for (uint32_t index = 0; index < sizeof(s_port_received) / sizeof(s_port_received[0]); index++) {
+        for (auto received = s_port_received[index]; received != 0; received &= received - 1U) {
+            dmxnode::Data::ClearLength(index * 32 + static_cast<uint32_t>(__builtin_ctz(received)));
         }
+        s_port_received[index] = 0;
     }
+
+    is_pushed_ = true;
 }
 
-void DdpDisplay::Input(const uint8_t* buffer, uint32_t size, [[maybe_unused]] uint32_t from_ip, [[maybe_unused]] uint16_t from_port) {
+void DdpDisplay::Input(const uint8_t* buffer, uint32_t size, uint32_t from_ip, [[maybe_unused]] uint16_t from_port) {
     if (__builtin_expect((size < ddp::HEADER_LEN), 0)) {
         return;
     }
 
-    if (from_ip_ == network::GetPrimaryIp()) {
+    if (from_ip == network::GetPrimaryIp()) {
         DEBUG_PUTS("Own message");
         return;
     }
 
+    receive_buffer_ = const_cast<uint8_t*>(buffer);
+    from_ip_ = from_ip;
+
     const auto* packet = reinterpret_cast<const ddp::Packet*>(buffer);
 
     if ((packet->header.flags1 & ddp::flags1::VER_MASK) != ddp::flags1::VER1) {
@@ -283,7 +349,7 @@ void DdpDisplay::Input(const uint8_t* buffer, uint32_t size, [[maybe_unused]] ui
     }
 
     if (packet->header.id == ddp::id::DISPLAY) {
-        HandleData();
+        HandleData(size);
         return;
     }
 
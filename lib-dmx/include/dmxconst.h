@@ -61,6 +61,7 @@ inline constexpr uint32_t kMabTimeMax = 1000000;                             ///
 inline constexpr uint32_t kRefreshRateDefault = 40;                          ///< 40 Hz
 inline constexpr uint32_t kPeriodDefault = (1000000U / kRefreshRateDefault); ///< 25000 us
 inline constexpr uint32_t kBreakToBreakTimeMin = 1204;                       ///< us
+inline constexpr uint32_t kSourceIntervalMax = 1000000;                      ///< us, a slower source is not followed
 } // namespace transmit
 } // namespace dmx
 
@@ -69,6 +69,10 @@ class Dmx {
     void SetTransmitSlots(uint16_t slots = dmx::kChannelsMax);
     [[nodiscard]] uint16_t TransmitSlots() const { return transmit_slots_; }
 
+    // The actual values for a port, derived from the data sent
+    [[nodiscard]] uint32_t TransmitPortSlots(uint32_t port_index) const { return transmit_length_[port_index]; }
+    [[nodiscard]] uint32_t TransmitPortPeriodTime(uint32_t port_index) const { return transmit_port_period_[port_index]; }
+
     template <dmx::SendStyle dmxSendStyle> 
     void SetTransmitDataWithSC(uint32_t port_index, const uint8_t* data, uint32_t length);
 
@@ -115,9 +119,19 @@ class Dmx {
 
     void StartRdmOutput(uint32_t port_index);
 
+    void UpdateTransmitPortPeriod(uint32_t port_index);
+#if !defined(CONFIG_DMX_DISABLE_ADAPTIVE_PERIOD)
+    void UpdateSourceInterval(uint32_t port_index);
+#endif // !defined(CONFIG_DMX_DISABLE_ADAPTIVE_PERIOD)
+
     uint32_t transmit_period_{dmx::transmit::kPeriodDefault};
     uint32_t transmit_period_requested_{dmx::transmit::kPeriodDefault};
     uint32_t transmit_length_[dmx::config::max::kPorts];
+    uint32_t transmit_port_period_[dmx::config::max::kPorts];
+#if !defined(CONFIG_DMX_DISABLE_ADAPTIVE_PERIOD)
+    uint32_t source_micros_[dmx::config::max::kPorts];
+    uint32_t source_interval_[dmx::config::max::kPorts]; ///< 0 when unknown
+#endif // !defined(CONFIG_DMX_DISABLE_ADAPTIVE_PERIOD)
     uint16_t transmit_slots_{dmx::kChannelsMax};
     dmx::Direction port_direction_[dmx::config::max::kPorts];
     bool has_continuous_output_{false};
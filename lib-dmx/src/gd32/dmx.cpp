@@ -55,6 +55,7 @@
 #if defined(LOGIC_ANALYZER)
 #include "logic_analyzer.h" // IWYU pragma: keep
 #endif                      // defined(LOGIC_ANALYZER)
+#include "firmware/debug/debug_profile.h"
 #include "dmx_debug.h"
 
 static_assert(dmx::buffer::kSize % 4 == 0); // multiple of uint32_t
@@ -73,11 +74,20 @@ struct DmxTxDataPacket {
     uint32_t length;
 };
 
+/*
+ * Triple buffer. The IRQ transmits data[read_index] and takes
+ * data[published_index] at the next break, so a frame is never changed while
+ * it is on the wire. The writer fills data[write_index], which is neither the
+ * one on the wire nor the published one. A published frame is therefore
+ * never withdrawn, only replaced by a newer one.
+ */
 struct DmxTxPacket {
-    DmxTxDataPacket data[2];
+    DmxTxDataPacket data[3];
+    volatile uint32_t read_index;      ///< Written by the IRQ
+    volatile uint32_t published_index; ///< Written by the writer
+    volatile bool is_published;
     uint32_t write_index;
-    uint32_t read_index;
-    bool data_pending;
+    bool data_pending; ///< Written, waiting for Sync
 };
 
 struct DmxTxData {
@@ -103,7 +113,7 @@ struct RdmTxData {
 struct DmxTransmit {
     uint32_t break_time;
     uint32_t mab_time;
-    uint32_t inter_time;
+    uint32_t inter_time[dmx::config::max::kPorts]; ///< Per port, depends on the length and period
 };
 
 struct RxDmxPackets {
@@ -362,8 +372,9 @@ template <uint32_t kUsartPeripheral, uint32_t kDmaController, dma_channel_enum k
 void DmaRestartDmxTx(TxBufferType& tx_buffer) {
     auto& dmx = tx_buffer.dmx;
 
-    if (dmx.read_index != dmx.write_index) {
-        dmx.read_index ^= 1;
+    if (dmx.is_published) {
+        dmx.read_index = dmx.published_index;
+        dmx.is_published = false;
     }
 
     const auto& packet = dmx.data[dmx.read_index];
@@ -371,6 +382,30 @@ void DmaRestartDmxTx(TxBufferType& tx_buffer) {
     DmaStartTx<kUsartPeripheral, kDmaController, kDmaChannel>(packet.data, packet.length);
 }
 
+/*
+ * The IRQ only moves read_index to published_index. A buffer that is neither
+ * of them cannot become the one on the wire while it is being written.
+ */
+inline uint32_t GetWriteIndex(const dmx::DmxTxPacket& dmx) {
+    const auto kReadIndex = dmx.read_index;
+    const auto kPublishedIndex = dmx.published_index;
+
+    for (uint32_t index = 0; index < 2; index++) {
+        if ((index != kReadIndex) && (index != kPublishedIndex)) {
+            return index;
+        }
+    }
+
+    return 2;
+}
+
+inline void Publish(dmx::DmxTxPacket& dmx) {
+    __DMB();
+    dmx.published_index = dmx.write_index;
+    __DMB();
+    dmx.is_published = true;
+}
+
 #define DMA_RESTART_DMX_TX(PORT_INDEX, USARTx, DMAx, CHx) DmaRestartDmxTx<USARTx, DMAx, CHx>(s_DmxTxBuffer[PORT_INDEX])
 
 template <uint32_t kUsartPeripheral, uint32_t kDmaController, dma_channel_enum kDmaChannel, typename TxBufferType>
@@ -1009,7 +1044,7 @@ void DMA1_Channel7_IRQHandler() {
             if (s_DmxTxBuffer[kPortIndex].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH0CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time;
+                TIMER_CH0CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time[kPortIndex];
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1035,7 +1070,7 @@ void DMA0_Channel3_IRQHandler() {
             if (s_DmxTxBuffer[kPortIndex].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH0CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time;
+                TIMER_CH0CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time[kPortIndex];
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1064,7 +1099,7 @@ void DMA0_Channel6_IRQHandler() {
             if (s_DmxTxBuffer[kPortIndex].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH1CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time;
+                TIMER_CH1CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time[kPortIndex];
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1093,7 +1128,7 @@ void DMA0_Channel3_IRQHandler() {
             if (s_DmxTxBuffer[kPortIndex].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH2CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time;
+                TIMER_CH2CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time[kPortIndex];
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1119,7 +1154,7 @@ void DMA0_Channel1_IRQHandler() {
             if (s_DmxTxBuffer[kPortIndex].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH2CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time;
+                TIMER_CH2CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time[kPortIndex];
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1149,7 +1184,7 @@ void DMA0_Channel4_IRQHandler() {
             if (s_DmxTxBuffer[kPortIndex].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH3CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time;
+                TIMER_CH3CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time[kPortIndex];
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1175,7 +1210,7 @@ void DMA1_Channel4_IRQHandler() {
             if (s_DmxTxBuffer[kPortIndex].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH3CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time;
+                TIMER_CH3CV(TIMER1) = TIMER_CNT(TIMER1) + s_dmx_transmit.inter_time[kPortIndex];
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1205,7 +1240,7 @@ void DMA1_Channel3_IRQHandler() {
             if (s_DmxTxBuffer[kPortIndex].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH0CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time;
+                TIMER_CH0CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time[kPortIndex];
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1232,7 +1267,7 @@ void DMA0_Channel7_IRQHandler() {
             if (s_DmxTxBuffer[kPortIndex].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH0CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time;
+                TIMER_CH0CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time[kPortIndex];
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1264,7 +1299,7 @@ void DMA1_Channel6_IRQHandler() {
             if (s_DmxTxBuffer[kPortIndex].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH1CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time;
+                TIMER_CH1CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time[kPortIndex];
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1291,7 +1326,7 @@ void DMA1_Channel4_IRQHandler() {
             if (s_DmxTxBuffer[dmx::config::kUart6Port].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[dmx::config::kUart6Port].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH2CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time;
+                TIMER_CH2CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time[dmx::config::kUart6Port];
                 s_DmxTxBuffer[dmx::config::kUart6Port].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1319,7 +1354,7 @@ void DMA0_Channel1_IRQHandler() {
             if (s_DmxTxBuffer[kPortIndex].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH2CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time;
+                TIMER_CH2CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time[kPortIndex];
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1347,7 +1382,7 @@ void DMA1_Channel3_IRQHandler() {
             if (s_DmxTxBuffer[dmx::config::kUart7Port].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[dmx::config::kUart7Port].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH3CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time;
+                TIMER_CH3CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time[dmx::config::kUart7Port];
                 s_DmxTxBuffer[dmx::config::kUart7Port].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1373,7 +1408,7 @@ void DMA0_Channel0_IRQHandler() {
             if (s_DmxTxBuffer[kPortIndex].output_style == dmx::OutputStyle::kDelta) {
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kIdle;
             } else {
-                TIMER_CH3CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time;
+                TIMER_CH3CV(TIMER4) = TIMER_CNT(TIMER4) + s_dmx_transmit.inter_time[kPortIndex];
                 s_DmxTxBuffer[kPortIndex].state = dmx::TxRxState::kDmxInter;
             }
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1523,9 +1558,18 @@ void Dmx::DataDisable(uint32_t port_index) {
 void Dmx::ClearData(uint32_t port_index) {
     assert(port_index < dmx::config::max::kPorts);
 
-    auto* data = &s_DmxTxBuffer[port_index].dmx.data[0];
-    data->length = dmx::kSlotsMax; // Including START Code
-    __builtin_memset(data->data, 0, dmx::buffer::kSize);
+    auto& packet = s_DmxTxBuffer[port_index].dmx;
+
+    for (auto& data : packet.data) {
+        data.length = dmx::kSlotsMax; // Including START Code
+        __builtin_memset(data.data, 0, dmx::buffer::kSize);
+    }
+
+    packet.read_index = 0;
+    packet.published_index = 0;
+    packet.write_index = 1;
+    packet.is_published = false;
+    packet.data_pending = false;
 }
 
 #if !defined(CONFIG_DMX_DISABLE_STATISTICS)
@@ -1556,15 +1600,21 @@ void Dmx::FullOn() {
         if (port_direction_[port_index] == dmx::Direction::kOutput) {
             DataDisable(port_index);
 
-            auto* __restrict__ data = &s_DmxTxBuffer[port_index].dmx.data[0];
-            auto* __restrict__ p32 = reinterpret_cast<uint32_t*>(data->data);
+            auto& packet = s_DmxTxBuffer[port_index].dmx;
 
-            for (auto i = 0; i < dmx::buffer::kSize / 4; i++) {
-                *p32++ = UINT32_MAX;
+            for (auto& data : packet.data) {
+                auto* __restrict__ p32 = reinterpret_cast<uint32_t*>(data.data);
+
+                for (auto i = 0; i < dmx::buffer::kSize / 4; i++) {
+                    *p32++ = UINT32_MAX;
+                }
+
+                data.data[0] = dmx::kStartCode;
+                data.length = dmx::kSlotsMax;
             }
 
-            data->data[0] = dmx::kStartCode;
-            data->length = dmx::kSlotsMax;
+            packet.is_published = false;
+            packet.data_pending = false;
 
             DataEnable(port_index);
         }
@@ -1583,21 +1633,17 @@ void Dmx::SetSendDataInternal(const uint8_t* data, uint32_t length) {
     }
 
     auto& tx_buffer = s_DmxTxBuffer[kPortIndex];
-    const auto kHasDataPending = tx_buffer.dmx.read_index != tx_buffer.dmx.write_index;
 
-    if (!kHasDataPending) {
-        // No pending data — switch to the other buffer
-        tx_buffer.dmx.write_index ^= 1;
+    // A frame waiting for Sync is overwritten in place
+    if (!tx_buffer.dmx.data_pending) {
+        tx_buffer.dmx.write_index = GetWriteIndex(tx_buffer.dmx);
     }
 
-    const auto kWriteIndex = tx_buffer.dmx.write_index;
-
-    auto* dst_data = tx_buffer.dmx.data[kWriteIndex].data;
+    auto& back = tx_buffer.dmx.data[tx_buffer.dmx.write_index];
+    auto* dst_data = back.data;
 
     const auto kCappedLength = (length < transmit_slots_) ? length : transmit_slots_;
-    tx_buffer.dmx.data[kWriteIndex].length = kCappedLength + 1;
-
-    tx_buffer.dmx.data_pending = true;
+    back.length = kCappedLength + 1;
 
     if constexpr (kHasStartCode) {
         memcpy(dst_data, data, kCappedLength);
@@ -1606,11 +1652,21 @@ void Dmx::SetSendDataInternal(const uint8_t* data, uint32_t length) {
         memcpy(&dst_data[1], data, kCappedLength);
     }
 
+    if constexpr (kSendStyle == dmx::SendStyle::kDirect) {
+        Publish(tx_buffer.dmx);
+    } else {
+        tx_buffer.dmx.data_pending = true;
+    }
+
     if (kCappedLength != transmit_length_[kPortIndex]) {
         transmit_length_[kPortIndex] = kCappedLength;
         SetTransmitPeriodTime(transmit_period_requested_);
     }
 
+#if !defined(CONFIG_DMX_DISABLE_ADAPTIVE_PERIOD)
+    UpdateSourceInterval(kPortIndex);
+#endif // !defined(CONFIG_DMX_DISABLE_ADAPTIVE_PERIOD)
+
     if constexpr (kSendStyle == dmx::SendStyle::kDirect) {
         StartSendStyleDirect(kPortIndex);
     }
@@ -2001,6 +2057,7 @@ void Dmx::StartRdmOutput(uint32_t port_index) {
 
 // DMX Output Synchronization
 void Dmx::Sync() {
+    DEBUG_PROFILE_SCOPE(kDmxSync);
     for (uint32_t port_index = 0; port_index < dmx::config::max::kPorts; port_index++) {
         auto& tx_buffer = s_DmxTxBuffer[port_index];
 
@@ -2009,6 +2066,7 @@ void Dmx::Sync() {
         }
 
         tx_buffer.dmx.data_pending = false;
+        Publish(tx_buffer.dmx);
 
         if (sv_port_state[port_index] == dmx::PortState::kTx) {
             if ((tx_buffer.output_style == dmx::OutputStyle::kDelta) && (tx_buffer.state == dmx::TxRxState::kIdle)) {
@@ -2285,12 +2343,13 @@ uint32_t Dmx::TransmitMabTime() const {
 void Dmx::SetTransmitPeriodTime(uint32_t period) {
     transmit_period_requested_ = period;
 
-    auto length_max = s_DmxTxBuffer[0].dmx.data[0].length;
+    uint32_t length_max = 0;
 
-    for (uint32_t port_index = 1; port_index < dmx::config::max::kPorts; port_index++) {
-        const auto kLength = s_DmxTxBuffer[port_index].dmx.data[0].length;
-        if (kLength > length_max) {
-            length_max = kLength;
+    for (uint32_t port_index = 0; port_index < dmx::config::max::kPorts; port_index++) {
+        for (const auto& data : s_DmxTxBuffer[port_index].dmx.data) {
+            if (data.length > length_max) {
+                length_max = data.length;
+            }
         }
     }
 
@@ -2316,10 +2375,72 @@ void Dmx::SetTransmitPeriodTime(uint32_t period) {
         transmit_period_ = std::max(dmx::transmit::kBreakToBreakTimeMin, package_length_micro_seconds + dmx::kSlotTime);
     }
 
-    s_dmx_transmit.inter_time = transmit_period_ - package_length_micro_seconds;
+    for (uint32_t port_index = 0; port_index < dmx::config::max::kPorts; port_index++) {
+        UpdateTransmitPortPeriod(port_index);
+    }
+
+    DMX_DEBUG_PRINTF("period=%u, length_max=%u, transmit_period_=%u, package_length_micro_seconds=%u", period, length_max, transmit_period_, package_length_micro_seconds);
+}
+
+/*
+ * A configured period is never exceeded, the port is transmitted at that rate.
+ * Without a configured period (0) the port follows the rate of its source.
+ * The lower bound is the time needed for the port's own slots, so a short
+ * universe is refreshed at a higher rate than a full one.
+ */
+void Dmx::UpdateTransmitPortPeriod(uint32_t port_index) {
+    const auto kPackage = s_dmx_transmit.break_time + s_dmx_transmit.mab_time + ((transmit_length_[port_index] + 1) * dmx::kSlotTime);
+    const auto kPeriodMin = std::max(dmx::transmit::kBreakToBreakTimeMin, kPackage + dmx::kSlotTime);
+
+    auto period = transmit_period_requested_;
+
+#if !defined(CONFIG_DMX_DISABLE_ADAPTIVE_PERIOD)
+    if (period == 0) {
+        period = source_interval_[port_index];
+    }
+#endif // !defined(CONFIG_DMX_DISABLE_ADAPTIVE_PERIOD)
+
+    if (period < kPeriodMin) {
+        period = kPeriodMin;
+    }
+
+    transmit_port_period_[port_index] = period;
+    s_dmx_transmit.inter_time[port_index] = period - kPackage;
+}
 
-    DMX_DEBUG_PRINTF("period=%u, length_max=%u, transmit_period_=%u, package_length_micro_seconds=%u -> s_dmx_transmit.inter_time=%u", period, length_max, transmit_period_, package_length_micro_seconds, s_dmx_transmit.inter_time);
+#if !defined(CONFIG_DMX_DISABLE_ADAPTIVE_PERIOD)
+void Dmx::UpdateSourceInterval(uint32_t port_index) {
+    const auto kNow = timing::Micros();
+    const auto kDelta = kNow - source_micros_[port_index];
+    source_micros_[port_index] = kNow;
+
+    auto& interval = source_interval_[port_index];
+
+    if (kDelta > dmx::transmit::kSourceIntervalMax) {
+        // The source paused, fall back to the configured period
+        if (interval != 0) {
+            interval = 0;
+            UpdateTransmitPortPeriod(port_index);
+        }
+        return;
+    }
+
+    // Moving average over 8 frames
+    interval = (interval == 0) ? kDelta : interval - (interval >> 3) + (kDelta >> 3);
+
+    // A configured period is not adapted
+    if (transmit_period_requested_ != 0) {
+        return;
+    }
+
+    const auto kPeriod = transmit_port_period_[port_index];
+    const auto kDiff = (interval > kPeriod) ? interval - kPeriod : kPeriod - interval;
+
+    if (kDiff > (kPeriod >> 4)) {
+        UpdateTransmitPortPeriod(port_index);
+    }
 }
+#endif // !defined(CONFIG_DMX_DISABLE_ADAPTIVE_PERIOD)
 
 [[gnu::noinline]]
 void Dmx::SetTransmitSlots(uint16_t slots) {
@@ -2776,9 +2897,9 @@ Dmx::Dmx() {
 
     s_dmx_transmit.break_time = dmx::transmit::kBreakTimeTypical;
     s_dmx_transmit.mab_time = dmx::transmit::kMabTimeMin;
-    s_dmx_transmit.inter_time = dmx::transmit::kPeriodDefault - s_dmx_transmit.break_time - s_dmx_transmit.mab_time - (dmx::kChannelsMax * dmx::kSlotTime) - dmx::kSlotTime;
 
     for (uint32_t port_index = 0; port_index < dmx::config::max::kPorts; port_index++) {
+        s_dmx_transmit.inter_time[port_index] = dmx::transmit::kPeriodDefault - s_dmx_transmit.break_time - s_dmx_transmit.mab_time - (dmx::kChannelsMax * dmx::kSlotTime) - dmx::kSlotTime;
         transmit_length_[port_index] = dmx::kChannelsMax;
         sv_rx_buffer[port_index].state = dmx::TxRxState::kIdle;
         s_DmxTxBuffer[port_index].state = dmx::TxRxState::kIdle;
@@ -23,42 +23,58 @@
   */
 
 #include <cstdint>
-#include <cstdio>
 
 #include "dmx.h"
+#include "json/json_writer.h"
 
 namespace json::status
 {
+static void Dmx(Writer& writer, uint32_t port_index) {
+    auto& statistics = Dmx::Get()->GetTotalStatistics(port_index);
+
+    writer.ObjectBegin();
+    writer.Field("port", static_cast<char>('A' + port_index));
+    writer.ObjectBegin("dmx");
+    writer.FieldQuoted("sent", statistics.dmx.sent);
+    writer.FieldQuoted("received", statistics.dmx.received);
+    const auto kPeriod = Dmx::Get()->TransmitPortPeriodTime(port_index);
+    writer.FieldQuoted("slots", Dmx::Get()->TransmitPortSlots(port_index));
+    writer.FieldQuoted("period", kPeriod);
+    writer.FieldQuoted("refresh", (kPeriod != 0) ? 1000000U / kPeriod : 0);
+    writer.ObjectEnd();
+    writer.ObjectBegin("rdm");
+    writer.ObjectBegin("sent");
+    writer.FieldQuoted("class", statistics.rdm.sent.classes);
+    writer.FieldQuoted("discovery", statistics.rdm.sent.discovery_response);
+    writer.ObjectEnd();
+    writer.ObjectBegin("received");
+    writer.FieldQuoted("good", statistics.rdm.received.good);
+    writer.FieldQuoted("bad", statistics.rdm.received.bad);
+    writer.FieldQuoted("discovery", statistics.rdm.received.discovery_response);
+    writer.ObjectEnd();
+    writer.ObjectEnd();
+    writer.ObjectEnd();
+}
+
 uint32_t Dmx(char* out_buffer, uint32_t out_buffer_size, uint32_t port_index) {
     if (port_index < ::dmx::config::max::kPorts)
     {
-        auto& statistics = Dmx::Get()->GetTotalStatistics(port_index);
-        auto length = static_cast<uint32_t>(snprintf(out_buffer, out_buffer_size,
-         "{\"port\":\"%c\","
-         "\"dmx\":{\"sent\":\"%u\",\"received\":\"%u\"},"
-         "\"rdm\":{\"sent\":{\"class\":\"%u\",\"discovery\":\"%u\"},\"received\":{\"good\":\"%u\",\"bad\":\"%u\",\"discovery\":\"%u\"}}}",
-         static_cast<char>('A' + port_index), static_cast<unsigned int>(statistics.dmx.sent), static_cast<unsigned int>(statistics.dmx.received),
-         static_cast<unsigned int>(statistics.rdm.sent.classes), static_cast<unsigned int>(statistics.rdm.sent.discovery_response), static_cast<unsigned int>(statistics.rdm.received.good),
-         static_cast<unsigned int>(statistics.rdm.received.bad), static_cast<unsigned int>(statistics.rdm.received.discovery_response)));
-
-        return length;
+        Writer writer(out_buffer, out_buffer_size);
+        Dmx(writer, port_index);
+        return writer.Finish();
     }
 
     return 0;	
 }
 
-uint32_t Dmx(char* out_buffer, uint32_t out_buffer_size) {
-    out_buffer[0] = '[';
-    uint32_t length = 1;
+void Dmx(Writer& writer) {
+    writer.ArrayBegin();
 
     for (uint32_t port_index = 0; port_index < ::dmx::config::max::kPorts; port_index++)
     {
-        length += Dmx(&out_buffer[length], out_buffer_size - length, port_index);
-		out_buffer[length++] = ',';
+        Dmx(writer, port_index);
     }
 
-    out_buffer[length - 1] = ']';
-
-    return length;	
+    writer.ArrayEnd();
 }
 }  // namespace json::status
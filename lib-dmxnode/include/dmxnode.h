@@ -67,6 +67,14 @@ inline constexpr uint32_t kDmxportOffset = CONFIG_DMXNODE_DMX_PORT_OFFSET; // Fr
 
 inline constexpr uint32_t kConfigPortCount = ((kMaxPorts - kDmxportOffset) <= common::store::dmxnode::kParamPorts) ? (kMaxPorts - kDmxportOffset) : common::store::dmxnode::kParamPorts;
 
+// Source buffers per port for merging. Art-Net uses A/B, sACN can use them all.
+#if !defined(CONFIG_DMXNODE_MERGE_SOURCES)
+inline constexpr uint32_t kMergeSources = 2; // Default if not overridden
+#else
+inline constexpr uint32_t kMergeSources = CONFIG_DMXNODE_MERGE_SOURCES; // From build config
+#endif
+static_assert((kMergeSources >= 2) && (kMergeSources <= 16), "kMergeSources out of range");
+
 enum class Personality { kArtnet, kSacn, kNode };
 
 enum class MergeMode { kHtp, kLtp };
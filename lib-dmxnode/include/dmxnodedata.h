@@ -31,6 +31,7 @@
 #include <cassert>
 
 #include "dmxnode.h"
+#include "firmware/debug/debug_profile.h"
 
 #if defined(GD32)
 /**
@@ -54,13 +55,50 @@ class Data {
         return instance;
     }
 
-    static void SetSourceA(uint32_t port_index, const uint8_t* data, uint32_t length) { Get().IMergeSourceA(port_index, data, length, MergeMode::kLtp); }
+    static void SetSourceA(uint32_t port_index, const uint8_t* data, uint32_t length) { Get().IMergeSource(port_index, 0, data, length, MergeMode::kLtp, kSourcesAB); }
 
-    static void MergeSourceA(uint32_t port_index, const uint8_t* data, uint32_t length, MergeMode merge_mode) { Get().IMergeSourceA(port_index, data, length, merge_mode); }
+    static void MergeSourceA(uint32_t port_index, const uint8_t* data, uint32_t length, MergeMode merge_mode) { Get().IMergeSource(port_index, 0, data, length, merge_mode, kSourcesAB); }
 
-    static void SetSourceB(uint32_t port_index, const uint8_t* data, uint32_t length) { Get().IMergeSourceB(port_index, data, length, MergeMode::kLtp); }
+    static void SetSourceB(uint32_t port_index, const uint8_t* data, uint32_t length) { Get().IMergeSource(port_index, 1, data, length, MergeMode::kLtp, kSourcesAB); }
 
-    static void MergeSourceB(uint32_t port_index, const uint8_t* data, uint32_t length, MergeMode merge_mode) { Get().IMergeSourceB(port_index, data, length, merge_mode); }
+    static void MergeSourceB(uint32_t port_index, const uint8_t* data, uint32_t length, MergeMode merge_mode) { Get().IMergeSource(port_index, 1, data, length, merge_mode, kSourcesAB); }
+
+    /**
+     * @param source_index 0 .. kMergeSources - 1
+     * @param sources_mask Bit mask of the sources taking part in the HTP merge
+     */
+    static void SetSource(uint32_t port_index, uint32_t source_index, const uint8_t* data, uint32_t length) { Get().IMergeSource(port_index, source_index, data, length, MergeMode::kLtp, 1U << source_index); }
+
+    static void MergeSource(uint32_t port_index, uint32_t source_index, const uint8_t* data, uint32_t length, MergeMode merge_mode, uint32_t sources_mask) { Get().IMergeSource(port_index, source_index, data, length, merge_mode, sources_mask); }
+
+    /**
+     * Copies a slot range of source A, the slots outside the range are kept.
+     * The output length grows to cover the range.
+     */
+    static void SetSlotsA(uint32_t port_index, uint32_t offset, const uint8_t* data, uint32_t length) { Get().ISetSlots(port_index, 0, offset, data, length); }
+
+    /**
+     * Only keeps the source data, the output is not changed.
+     */
+    static void StoreSource(uint32_t port_index, uint32_t source_index, const uint8_t* data, uint32_t length) { Get().IStoreSource(port_index, source_index, data, length); }
+
+#if defined(CONFIG_DMXNODE_SLOT_PRIORITY)
+    /**
+     * Per slot priority (sACN start code 0xDD), 0 means the slot is not sourced.
+     * The slot ownership cache is only rebuilt when the priorities or the sources change.
+     */
+    static void SetSlotPriority(uint32_t port_index, uint32_t source_index, const uint8_t* priority, uint32_t length) { Get().ISetSlotPriority(port_index, source_index, priority, length); }
+
+    /**
+     * Same priority for all slots, for a source without per slot priority.
+     */
+    static void SetSlotPriority(uint32_t port_index, uint32_t source_index, uint8_t priority) { Get().ISetSlotPriority(port_index, source_index, priority); }
+
+    /**
+     * Each slot is taken from the source with the highest priority for that slot, HTP on a tie.
+     */
+    static void MergeSlotPriority(uint32_t port_index, uint32_t source_index, const uint8_t* data, uint32_t length, uint32_t sources_mask) { Get().IMergeSlotPriority(port_index, source_index, data, length, sources_mask); }
+#endif
 
     static void Clear(uint32_t port_index) { Get().IClear(port_index); }
 
@@ -73,48 +111,241 @@ class Data {
     static void Restore(uint32_t port_index, const uint8_t* data) { Get().IRestore(port_index, data); }
 
    private:
-    void IMergeSourceA(uint32_t port_index, const uint8_t* data, uint32_t length, MergeMode merge_mode) {
+    /*
+     * Without merging, the data of the source is only kept in output_port.data.
+     * It is copied into its source buffer when that buffer is needed.
+     */
+    void IStoreDirect(uint32_t port_index) {
+        auto& output_port = output_port_[port_index];
+
+        if (output_port.direct_source != 0) {
+            memcpy(output_port.source[output_port.direct_source - 1U].data, output_port.data, output_port.length);
+            output_port.direct_source = 0;
+        }
+    }
+
+    void IStoreSource(uint32_t port_index, uint32_t source_index, const uint8_t* data, uint32_t length) {
         assert(port_index < kPorts);
+        assert(source_index < kMergeSources);
         assert(data != nullptr);
+        assert(length <= dmxnode::kUniverseSize);
+
+        auto& output_port = output_port_[port_index];
 
-        memcpy(output_port_[port_index].source_a.data, data, length);
+        if (output_port.direct_source == (source_index + 1U)) {
+            output_port.direct_source = 0;
+        } else {
+            IStoreDirect(port_index);
+        }
+
+        memcpy(output_port.source[source_index].data, data, length);
+    }
 
-        output_port_[port_index].length = length;
+    void IMergeSource(uint32_t port_index, uint32_t source_index, const uint8_t* data, uint32_t length, MergeMode merge_mode, uint32_t sources_mask) {
+        DEBUG_PROFILE_SCOPE(kDmxNodeMerge);
+        auto& output_port = output_port_[port_index];
 
         if (merge_mode == MergeMode::kHtp) {
-            for (uint32_t i = 0; i < length; i++) {
-                const auto kData = std::max(output_port_[port_index].source_a.data[i], output_port_[port_index].source_b.data[i]);
-                output_port_[port_index].data[i] = kData;
+            sources_mask &= (1U << kMergeSources) - 1U;
+
+            if ((sources_mask & (sources_mask - 1U)) != 0) {
+                IStoreSource(port_index, source_index, data, length);
+                output_port.length = length;
+
+                // Start with the lowest source in the mask, then max in the others
+                auto index = static_cast<uint32_t>(__builtin_ctz(sources_mask));
+                memcpy(output_port.data, output_port.source[index].data, length);
+                sources_mask &= sources_mask - 1U;
+
+                while (sources_mask != 0) {
+                    index = static_cast<uint32_t>(__builtin_ctz(sources_mask));
+                    sources_mask &= sources_mask - 1U;
+
+                    const auto* const kSource = output_port.source[index].data;
+                    for (uint32_t i = 0; i < length; i++) {
+                        output_port.data[i] = std::max(output_port.data[i], kSource[i]);
+                    }
+                }
+
+                return;
             }
+        }
 
-            return;
+        // Fast path, a single copy into the output data
+        if (output_port.direct_source != (source_index + 1U)) {
+            IStoreDirect(port_index);
         }
 
-        memcpy(output_port_[port_index].data, data, length);
+        memcpy(output_port.data, data, length);
+        output_port.length = length;
+        output_port.direct_source = static_cast<uint8_t>(source_index + 1U);
     }
 
-    void IMergeSourceB(uint32_t port_index, const uint8_t* data, uint32_t length, MergeMode merge_mode) {
+    void ISetSlots(uint32_t port_index, uint32_t source_index, uint32_t offset, const uint8_t* data, uint32_t length) {
         assert(port_index < kPorts);
+        assert(source_index < kMergeSources);
         assert(data != nullptr);
+        assert((offset + length) <= dmxnode::kUniverseSize);
 
-        memcpy(output_port_[port_index].source_b.data, data, length);
+        auto& output_port = output_port_[port_index];
 
-        output_port_[port_index].length = length;
+        if (output_port.direct_source != (source_index + 1U)) {
+            IStoreDirect(port_index);
+        }
 
-        if (merge_mode == MergeMode::kHtp) {
-            for (uint32_t i = 0; i < length; i++) {
-                const auto kData = std::max(output_port_[port_index].source_a.data[i], output_port_[port_index].source_b.data[i]);
-                output_port_[port_index].data[i] = kData;
+        memcpy(&output_port.data[offset], data, length);
+        output_port.length = std::max(output_port.length, offset + length);
+        output_port.direct_source = static_cast<uint8_t>(source_index + 1U);
+    }
+
+#if defined(CONFIG_DMXNODE_SLOT_PRIORITY)
+    static constexpr uint8_t kPriorityPerSlot = 0xFF; ///< Not a valid universe priority
+
+    void ISetSlotPriority(uint32_t port_index, uint32_t source_index, const uint8_t* priority, uint32_t length) {
+        assert(port_index < kPorts);
+        assert(source_index < kMergeSources);
+        assert(priority != nullptr);
+        assert(length <= dmxnode::kUniverseSize);
+
+        auto& slot_priority = slot_priority_[port_index];
+        auto* const kPriority = slot_priority.priority[source_index];
+
+        if ((slot_priority.source_priority[source_index] == kPriorityPerSlot) && (memcmp(kPriority, priority, length) == 0)) {
+            if ((length == dmxnode::kUniverseSize) || (kPriority[length] == 0)) {
+                return;
             }
+        }
+
+        memcpy(kPriority, priority, length);
+        memset(&kPriority[length], 0, dmxnode::kUniverseSize - length);
+
+        slot_priority.source_priority[source_index] = kPriorityPerSlot;
+        slot_priority.is_valid = false;
+    }
 
+    void ISetSlotPriority(uint32_t port_index, uint32_t source_index, uint8_t priority) {
+        assert(port_index < kPorts);
+        assert(source_index < kMergeSources);
+        assert(priority != kPriorityPerSlot);
+
+        auto& slot_priority = slot_priority_[port_index];
+
+        if (slot_priority.source_priority[source_index] == priority) {
             return;
         }
 
-        memcpy(output_port_[port_index].data, data, length);
+        memset(slot_priority.priority[source_index], priority, dmxnode::kUniverseSize);
+
+        slot_priority.source_priority[source_index] = priority;
+        slot_priority.is_valid = false;
+    }
+
+    /*
+     * For each slot the single owning source gets 0xFF in its select mask.
+     * Slots with more than one source at the highest priority are marked as tie.
+     */
+    void SlotPriorityUpdate(uint32_t port_index, uint32_t sources_mask) {
+        auto& slot_priority = slot_priority_[port_index];
+
+        slot_priority.sources_count = 0;
+
+        for (uint32_t mask = sources_mask; mask != 0; mask &= mask - 1U) {
+            const auto kIndex = static_cast<uint32_t>(__builtin_ctz(mask));
+            slot_priority.sources[slot_priority.sources_count++] = static_cast<uint8_t>(kIndex);
+            memset(slot_priority.select[kIndex], 0, dmxnode::kUniverseSize);
+        }
+
+        memset(slot_priority.tie, 0, sizeof(slot_priority.tie));
+
+        for (uint32_t i = 0; i < dmxnode::kUniverseSize; i++) {
+            uint8_t highest = 0;
+            uint32_t owners = 0;
+
+            for (uint32_t n = 0; n < slot_priority.sources_count; n++) {
+                const auto kIndex = slot_priority.sources[n];
+                const auto kPriority = slot_priority.priority[kIndex][i];
+
+                if (kPriority > highest) {
+                    highest = kPriority;
+                    owners = (1U << kIndex);
+                } else if ((kPriority == highest) && (kPriority != 0)) {
+                    owners |= (1U << kIndex);
+                }
+            }
+
+            if (owners == 0) {
+                continue;
+            }
+
+            if ((owners & (owners - 1U)) == 0) {
+                slot_priority.select[__builtin_ctz(owners)][i] = 0xFF;
+            } else {
+                slot_priority.tie[i / 32] |= (1U << (i & 31));
+            }
+        }
+
+        slot_priority.sources_mask = sources_mask;
+        slot_priority.is_valid = true;
+    }
+
+    void IMergeSlotPriority(uint32_t port_index, uint32_t source_index, const uint8_t* data, uint32_t length, uint32_t sources_mask) {
+        DEBUG_PROFILE_SCOPE(kDmxNodeMerge);
+        IStoreSource(port_index, source_index, data, length);
+
+        auto& output_port = output_port_[port_index];
+        auto& slot_priority = slot_priority_[port_index];
+
+        sources_mask &= (1U << kMergeSources) - 1U;
+
+        if (!slot_priority.is_valid || (slot_priority.sources_mask != sources_mask)) {
+            SlotPriorityUpdate(port_index, sources_mask);
+        }
+
+        output_port.length = length;
+
+        // Word by word, a slot is only selected in its owning source
+        auto* out = reinterpret_cast<uint32_t*>(output_port.data);
+        const auto kWords = (length + 3U) / 4U;
+
+        for (uint32_t w = 0; w < kWords; w++) {
+            uint32_t value = 0;
+
+            for (uint32_t n = 0; n < slot_priority.sources_count; n++) {
+                const auto kIndex = slot_priority.sources[n];
+                value |= reinterpret_cast<const uint32_t*>(output_port.source[kIndex].data)[w] & reinterpret_cast<const uint32_t*>(slot_priority.select[kIndex])[w];
+            }
+
+            out[w] = value;
+        }
+
+        // HTP between the sources sharing the highest priority of a slot
+        for (uint32_t t = 0; t < (length + 31U) / 32U; t++) {
+            for (auto tie = slot_priority.tie[t]; tie != 0; tie &= tie - 1U) {
+                const auto kSlot = t * 32U + static_cast<uint32_t>(__builtin_ctz(tie));
+                uint8_t highest = 0;
+                uint8_t value = 0;
+
+                for (uint32_t n = 0; n < slot_priority.sources_count; n++) {
+                    const auto kIndex = slot_priority.sources[n];
+                    const auto kPriority = slot_priority.priority[kIndex][kSlot];
+
+                    if (kPriority > highest) {
+                        highest = kPriority;
+                        value = output_port.source[kIndex].data[kSlot];
+                    } else if (kPriority == highest) {
+                        value = std::max(value, output_port.source[kIndex].data[kSlot]);
+                    }
+                }
+
+                output_port.data[kSlot] = value;
+            }
+        }
     }
+#endif
 
     void IClear(uint32_t port_index) {
         assert(port_index < kPorts);
+        IStoreDirect(port_index);
 
         memset(output_port_[port_index].data, 0, dmxnode::kUniverseSize);
         output_port_[port_index].length = dmxnode::kUniverseSize;
@@ -122,6 +353,7 @@ class Data {
 
     void IClearLength(uint32_t port_index) {
         assert(port_index < kPorts);
+        IStoreDirect(port_index);
         output_port_[port_index].length = 0;
     }
 
@@ -138,6 +370,7 @@ class Data {
     void IRestore(uint32_t port_index, const uint8_t* data) {
         assert(port_index < kPorts);
         assert(data != nullptr);
+        IStoreDirect(port_index);
 
         memcpy(output_port_[port_index].data, data, dmxnode::kUniverseSize);
     }
@@ -156,14 +389,31 @@ class Data {
         uint8_t data[dmxnode::kUniverseSize] __attribute__((aligned(4)));
     };
 
+    static constexpr uint32_t kSourcesAB = 0x3;
+
     struct OutputPort {
-        Source source_a;
-        Source source_b;
+        Source source[kMergeSources];
         uint8_t data[dmxnode::kUniverseSize] __attribute__((aligned(4)));
         uint32_t length;
+        uint8_t direct_source; ///< Source index + 1 of the data only kept in data, 0 = none
     };
 
     OutputPort output_port_[kPorts];
+
+#if defined(CONFIG_DMXNODE_SLOT_PRIORITY)
+    struct SlotPriority {
+        uint8_t priority[kMergeSources][dmxnode::kUniverseSize];
+        uint8_t select[kMergeSources][dmxnode::kUniverseSize] __attribute__((aligned(4)));
+        uint32_t tie[dmxnode::kUniverseSize / 32];
+        uint32_t sources_mask;
+        uint8_t source_priority[kMergeSources]; ///< Universe priority, or kPriorityPerSlot
+        uint8_t sources[kMergeSources];
+        uint32_t sources_count;
+        bool is_valid;
+    };
+
+    SlotPriority slot_priority_[kPorts];
+#endif
 };
 } // namespace dmxnode
 
@@ -24,6 +24,7 @@
  */
 
 #include <cstdint>
+#include <cstring>
 
 #include "dmxnode.h"
 #include "dmxnodedata.h"
@@ -54,7 +55,12 @@ void DmxNode::ScenePlayback() {
         auto& port = port_[port_index];
 
         if (port.port_direction == dmxnode::Direction::kOutput) {
-            dmxnode::scenes::Read(port_index, const_cast<uint8_t*>(dmxnode::Data::Backup(port_index)));
+            // As source A, the data of a direct source is kept before the output is overwritten
+            uint8_t data[dmxnode::kUniverseSize] __attribute__((aligned(4)));
+            memcpy(data, dmxnode::Data::Backup(port_index), dmxnode::kUniverseSize);
+
+            dmxnode::scenes::Read(port_index, data);
+            dmxnode::Data::SetSourceA(port_index, data, dmxnode::kUniverseSize);
             dmxnode::DataOutput(dmxnode_output_type, port_index);
 
             if (!port.is_transmitting) {
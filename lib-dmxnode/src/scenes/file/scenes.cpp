@@ -30,131 +30,120 @@
 #include <cstdint>
 #include <cstdio>
 #include <cassert>
-#include <unistd.h>
 
-#include "dmxnode.h"
+#include "../scenes_store.h"
 #include "firmware/debug/debug_debug.h"
 
-namespace dmxnode::scenes {
-
+namespace dmxnode::scenes::store {
 static constexpr char kFileName[] = "failsafe.bin";
 
 static FILE* s_file;
 
-void WriteStart() {
+bool Init() {
     DEBUG_ENTRY();
 
-    if ((s_file = fopen(kFileName, "r+")) == nullptr) {
-        perror("fopen r+");
+    if (s_file != nullptr) {
+        DEBUG_EXIT();
+        return true;
+    }
 
-        if ((s_file = fopen(kFileName, "w+")) == nullptr) {
-            perror("fopen w+");
+    if ((s_file = fopen(kFileName, "r+")) != nullptr) {
+        DEBUG_EXIT();
+        return true;
+    }
 
-            DEBUG_EXIT();
-            return;
-        }
+    perror("fopen r+");
 
-        for (uint32_t i = 0; i < dmxnode::scenes::kBytesNeeded; i++) {
-            if (fputc(0xFF, s_file) == EOF) {
-                perror("fputc(0xFF, file)"); // Same as erasing a flash memory device
+    if ((s_file = fopen(kFileName, "w+")) == nullptr) {
+        perror("fopen w+");
+        DEBUG_EXIT();
+        return false;
+    }
 
-                if (fclose(s_file) != 0) {
-                    perror("flcose");
-                }
+    for (uint32_t i = 0; i < (kSlots * kSlotSize); i++) {
+        if (fputc(0xFF, s_file) == EOF) {
+            perror("fputc(0xFF, file)"); // Same as erasing a flash memory device
 
-                s_file = nullptr;
-                DEBUG_EXIT();
-                return;
+            if (fclose(s_file) != 0) {
+                perror("flcose");
             }
-        }
 
-        if (fflush(s_file) != 0) {
-            perror("fflush");
+            s_file = nullptr;
+            DEBUG_EXIT();
+            return false;
         }
     }
 
+    if (fflush(s_file) != 0) {
+        perror("fflush");
+    }
+
     DEBUG_EXIT();
+    return true;
 }
 
-void Write(uint32_t port_index, const uint8_t* data) {
-    DEBUG_ENTRY();
-    assert(port_index < dmxnode::kMaxPorts);
-    assert(data != nullptr);
+bool Erase(uint32_t slot) {
+    assert(slot < kSlots);
+    assert(s_file != nullptr);
 
-    if (fseek(s_file, static_cast<long int>(port_index * dmxnode::kUniverseSize), SEEK_SET) != 0) {
+    if (fseek(s_file, static_cast<long int>(slot * kSlotSize), SEEK_SET) != 0) {
         perror("fseek");
-        DEBUG_EXIT();
-        return;
+        return false;
     }
 
-    if (fwrite(data, 1, dmxnode::kUniverseSize, s_file) != dmxnode::kUniverseSize) {
-        perror("fwrite");
-        DEBUG_EXIT();
-        return;
+    for (uint32_t i = 0; i < kSlotSize; i++) {
+        if (fputc(0xFF, s_file) == EOF) {
+            perror("fputc(0xFF, file)");
+            return false;
+        }
     }
 
-    DEBUG_EXIT();
+    return true;
 }
 
-void WriteEnd() {
-    DEBUG_ENTRY();
+bool Program(uint32_t slot, uint32_t offset, const uint8_t* data, uint32_t length) {
+    assert(slot < kSlots);
+    assert((offset + length) <= kSlotSize);
+    assert(s_file != nullptr);
 
-    if (s_file != nullptr) {
-        if (fclose(s_file) != 0) {
-            perror("flcose");
-        }
-        s_file = nullptr;
+    if (fseek(s_file, static_cast<long int>((slot * kSlotSize) + offset), SEEK_SET) != 0) {
+        perror("fseek");
+        return false;
     }
 
-    DEBUG_EXIT();
-}
-
-void ReadStart() {
-    DEBUG_ENTRY();
+    if (fwrite(data, 1, length, s_file) != length) {
+        perror("fwrite");
+        return false;
+    }
 
-    if ((s_file = fopen(kFileName, "r")) == nullptr) {
-        perror("fopen r");
-        DEBUG_EXIT();
+    if (fflush(s_file) != 0) {
+        perror("fflush");
+        return false;
     }
 
-    DEBUG_EXIT();
+    return true;
 }
 
-void Read(uint32_t port_index, uint8_t* data) {
-    DEBUG_ENTRY();
-    assert(port_index < dmxnode::kMaxPorts);
-    assert(data != nullptr);
+bool Load(uint32_t slot, uint32_t offset, uint8_t* data, uint32_t length) {
+    assert(slot < kSlots);
+    assert((offset + length) <= kSlotSize);
+    assert(s_file != nullptr);
 
-    if (s_file == nullptr) {
-        DEBUG_EXIT();
-        return;
-    }
-
-    if (fseek(s_file, static_cast<long int>(port_index * dmxnode::kUniverseSize), SEEK_SET) != 0) {
+    if (fseek(s_file, static_cast<long int>((slot * kSlotSize) + offset), SEEK_SET) != 0) {
         perror("fseek");
-        DEBUG_EXIT();
-        return;
+        return false;
     }
 
-    if (fread(data, 1, dmxnode::kUniverseSize, s_file) != dmxnode::kUniverseSize) {
+    if (fread(data, 1, length, s_file) != length) {
         perror("fread");
-        DEBUG_EXIT();
-        return;
+        return false;
     }
 
-    DEBUG_EXIT();
+    return true;
 }
 
-void ReadEnd() {
-    DEBUG_ENTRY();
-
-    if (s_file != nullptr) {
-        if (fclose(s_file) != 0) {
-            perror("flcose");
-        }
-        s_file = nullptr;
-    }
-
-    DEBUG_EXIT();
+bool LoadLegacy(uint32_t offset, uint8_t* data, uint32_t length) {
+    // The legacy scene is at the start of the file
+    return Load(0, offset, data, length);
 }
-} // namespace dmxnode::scenes
+} // namespace dmxnode::scenes::store
@@ -2,7 +2,7 @@
  * @file scenes.cpp
  *
  */
-/* Copyright (C) 2022 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2022-2026 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -26,18 +26,17 @@
 #include <cstdint>
 #include <cassert>
 
-#include "dmxnode_scenes.h"
+#include "../scenes_store.h"
 #include "flashcode.h"
 #include "dmxnode_debug.h"
 
-namespace dmxnode::scenes {
-
+namespace dmxnode::scenes::store {
 static bool s_is_detected;
 static uint32_t s_offset_base;
 
-static bool IsDetected() {
+bool Init() {
     DMXNODE_DEBUG_ENTRY();
-    DMXNODE_DEBUG_PRINTF("isDetected=%d", s_is_detected);
+    DMXNODE_DEBUG_PRINTF("s_is_detected=%d", s_is_detected);
 
     if (!s_is_detected) {
         if (!FlashCode::Get()->IsDetected()) {
@@ -45,128 +44,57 @@ static bool IsDetected() {
             return false;
         }
 
-        const auto kEraseSize = FlashCode::Get()->GetSectorSize();
-        assert(kEraseSize <= dmxnode::scenes::kBytesNeeded);
-        const auto kPages = 1 + dmxnode::scenes::kBytesNeeded / kEraseSize;
-
-        DMXNODE_DEBUG_PRINTF("Bytes needed=%u, kEraseSize=%u, kPages=%u", dmxnode::scenes::kBytesNeeded, kEraseSize, kPages);
+        assert(FlashCode::Get()->GetSectorSize() == kSectorSize);
+        // The last sector is kept free
+        assert(((kSlots * kSlotSize) + kSectorSize) <= FlashCode::Get()->GetSize());
 
-        assert(((kPages + 1) * kEraseSize) <= FlashCode::Get()->GetSize());
+        s_offset_base = FlashCode::Get()->GetSize() - ((kSlots * kSlotSize) + kSectorSize);
+        s_is_detected = true;
 
-        s_offset_base = FlashCode::Get()->GetSize() - ((kPages + 1) * kEraseSize);
-
-        DMXNODE_DEBUG_PRINTF("nOffsetBase=%p", s_offset_base);
+        DMXNODE_DEBUG_PRINTF("kSlotSize=%u, s_offset_base=%p", kSlotSize, s_offset_base);
     }
 
     DMXNODE_DEBUG_EXIT();
     return true;
 }
 
-void WriteStart() {
-    DMXNODE_DEBUG_ENTRY();
-    DMXNODE_DEBUG_PRINTF("isDetected=%d", s_is_detected);
-
-    if (!IsDetected()) {
-        DMXNODE_DEBUG_EXIT();
-        return;
-    }
+bool Erase(uint32_t slot) {
+    assert(slot < kSlots);
 
     flashcode::Result result;
-    uint32_t timeout = 0;
 
-    while (!FlashCode::Get()->Erase(s_offset_base, FlashCode::Get()->GetSectorSize(), result)) {
-        timeout++;
+    while (!FlashCode::Get()->Erase(s_offset_base + (slot * kSlotSize), kSlotSize, result)) {
     }
 
-    s_is_detected = (result == flashcode::Result::kOk);
-
-    DMXNODE_DEBUG_PRINTF("result=%d, s_is_detected=%d, timeout=%u", result, s_is_detected, timeout);
-    DMXNODE_DEBUG_EXIT();
+    return result == flashcode::Result::kOk;
 }
 
-void Write(uint32_t port_index, const uint8_t* data) {
-    DMXNODE_DEBUG_ENTRY();
-    assert(port_index < dmxnode::kMaxPorts);
-    assert(data != nullptr);
-
-    if (!s_is_detected) {
-        DMXNODE_DEBUG_EXIT();
-        return;
-    }
-
-    const auto kOffset = s_offset_base + (port_index * dmxnode::kUniverseSize);
-
-    DMXNODE_DEBUG_PRINTF("s_offset_base=%p, kOffset=%p", s_offset_base, kOffset);
+bool Program(uint32_t slot, uint32_t offset, const uint8_t* data, uint32_t length) {
+    assert(slot < kSlots);
+    assert((offset + length) <= kSlotSize);
 
     flashcode::Result result;
-    uint32_t timeout = 0;
-
-    while (!FlashCode::Get()->Write(kOffset, dmxnode::kUniverseSize, data, result)) {
-        timeout++;
-    }
-
-    DMXNODE_DEBUG_PRINTF("nResult=%d, nTimeout=%u", result, timeout);
-
-    assert(result == flashcode::Result::kOk);
-
-    DMXNODE_DEBUG_EXIT();
-}
-
-void WriteEnd() {
-    DMXNODE_DEBUG_ENTRY();
-
-    // No code needed here
-
-    DMXNODE_DEBUG_EXIT();
-}
-
-void ReadStart() {
-    DMXNODE_DEBUG_ENTRY();
-    DMXNODE_DEBUG_PRINTF("s_is_detected=%d", s_is_detected);
 
-    if (!IsDetected()) {
-        DMXNODE_DEBUG_EXIT();
-        return;
+    while (!FlashCode::Get()->Write(s_offset_base + (slot * kSlotSize) + offset, length, data, result)) {
     }
 
-    s_is_detected = true;
-
-    DMXNODE_DEBUG_EXIT();
+    return result == flashcode::Result::kOk;
 }
 
-void Read(uint32_t port_index, uint8_t* data) {
-    DMXNODE_DEBUG_ENTRY();
-    assert(port_index < dmxnode::kMaxPorts);
-    assert(data != nullptr);
-
-    if (!s_is_detected) {
-        DMXNODE_DEBUG_EXIT();
-        return;
-    }
-
-    const auto kOffset = s_offset_base + (port_index * dmxnode::kUniverseSize);
-
-    DMXNODE_DEBUG_PRINTF("nOffsetBase=%p, nOffset=%p", s_offset_base, kOffset);
+bool Load(uint32_t slot, uint32_t offset, uint8_t* data, uint32_t length) {
+    assert(slot < kSlots);
+    assert((offset + length) <= kSlotSize);
 
     flashcode::Result result;
-    uint32_t timeout = 0;
 
-    while (!FlashCode::Get()->Read(kOffset, dmxnode::kUniverseSize, data, result)) {
-        timeout++;
+    while (!FlashCode::Get()->Read(s_offset_base + (slot * kSlotSize) + offset, length, data, result)) {
     }
 
-    DMXNODE_DEBUG_PRINTF("result=%d, timeout=%u", result, timeout);
-
-    assert(result == flashcode::Result::kOk);
-
-    DMXNODE_DEBUG_EXIT();
+    return result == flashcode::Result::kOk;
 }
 
-void ReadEnd() {
-    DMXNODE_DEBUG_ENTRY();
-
-    // No code needed here
-
-    DMXNODE_DEBUG_EXIT();
+bool LoadLegacy(uint32_t offset, uint8_t* data, uint32_t length) {
+    // The legacy area ends where slot B ends
+    return Load(1, kSlotSize - kLegacySize + offset, data, length);
 }
-} // namespace dmxnode::scenes
+} // namespace dmxnode::scenes::store
@@ -0,0 +1,389 @@
+/**
+ * @file scenes.cpp
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+
+#include "dmxnode.h"
+#include "scenes_store.h"
+#include "dmxnode_debug.h"
+
+/*
+ * Scene layout in a slot:
+ *
+ *   header  : magic, sequence, payload length, checksum (FNV-1a over payload)
+ *   payload : one record per recorded port
+ *             port index, 0, encoded length (le16), tokens, padded to 4 bytes
+ *
+ * The slots are encoded as a delta against an all-zero universe:
+ *   0x80 | (n - 1) : n zero slots
+ *          (n - 1) : n literal bytes follow
+ * A blacked out port costs 8 bytes instead of 512.
+ */
+namespace dmxnode::scenes {
+namespace {
+inline constexpr uint32_t kMagic = 0x314E4353; // "SCN1"
+inline constexpr uint32_t kNoSlot = store::kSlots;
+inline constexpr uint32_t kRunMax = 128;
+
+struct Header {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t length;
+    uint32_t checksum;
+};
+
+static_assert(sizeof(Header) == store::kHeaderSize);
+
+alignas(uint32_t) uint8_t s_record[store::kMaxRecordSize];
+
+uint32_t s_slot{kNoSlot};  ///< Slot holding the last good scene
+uint32_t s_sequence;
+uint32_t s_write_slot{kNoSlot};
+uint32_t s_write_offset;
+uint32_t s_write_checksum;
+bool s_is_read_valid;
+bool s_is_read_legacy;
+
+constexpr uint32_t kFnvBasis = 2166136261U;
+constexpr uint32_t kFnvPrime = 16777619U;
+
+uint32_t Checksum(uint32_t hash, const uint8_t* data, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * kFnvPrime;
+    }
+    return hash;
+}
+
+uint32_t Encode(const uint8_t* data, uint8_t* out) {
+    uint32_t i = 0;
+    uint32_t n = 0;
+
+    while (i < dmxnode::kUniverseSize) {
+        uint32_t run = 0;
+
+        if (data[i] == 0) {
+            while ((i + run < dmxnode::kUniverseSize) && (run < kRunMax) && (data[i + run] == 0)) {
+                run++;
+            }
+            out[n++] = static_cast<uint8_t>(0x80 | (run - 1));
+        } else {
+            // A single zero is cheaper inside a literal run
+            while ((i + run < dmxnode::kUniverseSize) && (run < kRunMax)) {
+                if ((data[i + run] == 0) && ((i + run + 1 == dmxnode::kUniverseSize) || (data[i + run + 1] == 0))) {
+                    break;
+                }
+                run++;
+            }
+            out[n++] = static_cast<uint8_t>(run - 1);
+            memcpy(&out[n], &data[i], run);
+            n += run;
+        }
+
+        i += run;
+    }
+
+    assert(n <= store::kMaxEncodedSize);
+    return n;
+}
+
+bool Decode(const uint8_t* in, uint32_t length, uint8_t* data) {
+    uint32_t i = 0;
+    uint32_t n = 0;
+
+    while ((n < length) && (i < dmxnode::kUniverseSize)) {
+        const auto kToken = in[n++];
+        const auto kRun = 1U + (kToken & 0x7F);
+
+        if ((i + kRun) > dmxnode::kUniverseSize) {
+            return false;
+        }
+
+        if ((kToken & 0x80) != 0) {
+            memset(&data[i], 0, kRun);
+        } else {
+            if ((n + kRun) > length) {
+                return false;
+            }
+            memcpy(&data[i], &in[n], kRun);
+            n += kRun;
+        }
+
+        i += kRun;
+    }
+
+    memset(&data[i], 0, dmxnode::kUniverseSize - i);
+    return true;
+}
+
+bool IsValid(uint32_t slot, Header& header) {
+    if (!store::Load(slot, 0, reinterpret_cast<uint8_t*>(&header), sizeof(Header))) {
+        return false;
+    }
+
+    if ((header.magic != kMagic) || (header.length > (store::kSlotSize - store::kHeaderSize)) || ((header.length & 3) != 0)) {
+        return false;
+    }
+
+    auto checksum = kFnvBasis;
+
+    for (uint32_t offset = 0; offset < header.length; offset += sizeof(s_record)) {
+        auto length = header.length - offset;
+        if (length > sizeof(s_record)) {
+            length = sizeof(s_record);
+        }
+
+        if (!store::Load(slot, store::kHeaderSize + offset, s_record, length)) {
+            return false;
+        }
+
+        checksum = Checksum(checksum, s_record, length);
+    }
+
+    return checksum == header.checksum;
+}
+
+/*
+ * Finds the slot with the most recent valid scene
+ */
+void Scan() {
+    s_slot = kNoSlot;
+
+    for (uint32_t slot = 0; slot < store::kSlots; slot++) {
+        Header header;
+
+        if (!IsValid(slot, header)) {
+            DMXNODE_DEBUG_PRINTF("Slot %u is not valid", slot);
+            continue;
+        }
+
+        if ((s_slot == kNoSlot) || (static_cast<int32_t>(header.sequence - s_sequence) > 0)) {
+            s_slot = slot;
+            s_sequence = header.sequence;
+        }
+    }
+
+    DMXNODE_DEBUG_PRINTF("s_slot=%u, s_sequence=%u", s_slot, s_sequence);
+}
+
+/*
+ * A scene written by earlier firmware, raw and without a header. Erased flash reads as 0xFF.
+ */
+bool IsLegacy() {
+    for (uint32_t offset = 0; offset < dmxnode::scenes::kBytesNeeded; offset += dmxnode::kUniverseSize) {
+        if (!store::LoadLegacy(offset, s_record, dmxnode::kUniverseSize)) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < dmxnode::kUniverseSize; i++) {
+            if (s_record[i] != 0xFF) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+} // namespace
+
+void WriteStart() {
+    DMXNODE_DEBUG_ENTRY();
+
+    s_write_slot = kNoSlot;
+
+    if (!store::Init()) {
+        DMXNODE_DEBUG_EXIT();
+        return;
+    }
+
+    Scan();
+
+    const auto kSlot = (s_slot == kNoSlot) ? 0 : (s_slot + 1) % store::kSlots;
+
+    if (!store::Erase(kSlot)) {
+        DMXNODE_DEBUG_EXIT();
+        return;
+    }
+
+    s_write_slot = kSlot;
+    s_write_offset = store::kHeaderSize;
+    s_write_checksum = kFnvBasis;
+
+    DMXNODE_DEBUG_PRINTF("s_write_slot=%u", s_write_slot);
+    DMXNODE_DEBUG_EXIT();
+}
+
+void Write(uint32_t port_index, const uint8_t* data) {
+    DMXNODE_DEBUG_ENTRY();
+    assert(port_index < dmxnode::kMaxPorts);
+    assert(data != nullptr);
+
+    if (s_write_slot == kNoSlot) {
+        DMXNODE_DEBUG_EXIT();
+        return;
+    }
+
+    const auto kEncodedLength = Encode(data, &s_record[store::kRecordHeaderSize]);
+    auto length = store::kRecordHeaderSize + kEncodedLength;
+
+    s_record[0] = static_cast<uint8_t>(port_index);
+    s_record[1] = 0;
+    s_record[2] = static_cast<uint8_t>(kEncodedLength);
+    s_record[3] = static_cast<uint8_t>(kEncodedLength >> 8);
+
+    while ((length & 3) != 0) {
+        s_record[length++] = 0;
+    }
+
+    assert((s_write_offset + length) <= store::kSlotSize);
+
+    if (!store::Program(s_write_slot, s_write_offset, s_record, length)) {
+        s_write_slot = kNoSlot;
+        DMXNODE_DEBUG_EXIT();
+        return;
+    }
+
+    s_write_checksum = Checksum(s_write_checksum, s_record, length);
+    s_write_offset += length;
+
+    DMXNODE_DEBUG_PRINTF("port_index=%u, length=%u", port_index, length);
+    DMXNODE_DEBUG_EXIT();
+}
+
+void WriteEnd() {
+    DMXNODE_DEBUG_ENTRY();
+
+    if (s_write_slot == kNoSlot) {
+        DMXNODE_DEBUG_EXIT();
+        return;
+    }
+
+    // Programming the header commits the scene
+    const Header kHeader = {
+        .magic = kMagic,
+        .sequence = (s_slot == kNoSlot) ? 0 : s_sequence + 1,
+        .length = s_write_offset - store::kHeaderSize,
+        .checksum = s_write_checksum,
+    };
+
+    if (store::Program(s_write_slot, 0, reinterpret_cast<const uint8_t*>(&kHeader), sizeof(Header))) {
+        s_slot = s_write_slot;
+        s_sequence = kHeader.sequence;
+    }
+
+    s_write_slot = kNoSlot;
+
+    DMXNODE_DEBUG_PRINTF("s_slot=%u, s_sequence=%u", s_slot, s_sequence);
+    DMXNODE_DEBUG_EXIT();
+}
+
+void ReadStart() {
+    DMXNODE_DEBUG_ENTRY();
+
+    s_is_read_valid = false;
+    s_is_read_legacy = false;
+
+    if (!store::Init()) {
+        DMXNODE_DEBUG_EXIT();
+        return;
+    }
+
+    Scan();
+
+    s_is_read_valid = (s_slot != kNoSlot);
+
+    if (!s_is_read_valid) {
+        s_is_read_legacy = IsLegacy();
+        DMXNODE_DEBUG_PRINTF("s_is_read_legacy=%d", s_is_read_legacy);
+    }
+
+    DMXNODE_DEBUG_EXIT();
+}
+
+void Read(uint32_t port_index, uint8_t* data) {
+    DMXNODE_DEBUG_ENTRY();
+    assert(port_index < dmxnode::kMaxPorts);
+    assert(data != nullptr);
+
+    if (s_is_read_legacy) {
+        store::LoadLegacy(port_index * dmxnode::kUniverseSize, data, dmxnode::kUniverseSize);
+        DMXNODE_DEBUG_EXIT();
+        return;
+    }
+
+    if (!s_is_read_valid) {
+        DMXNODE_DEBUG_EXIT();
+        return;
+    }
+
+    Header header;
+
+    if (!store::Load(s_slot, 0, reinterpret_cast<uint8_t*>(&header), sizeof(Header))) {
+        DMXNODE_DEBUG_EXIT();
+        return;
+    }
+
+    const auto kEnd = store::kHeaderSize + header.length;
+    auto offset = store::kHeaderSize;
+
+    while (offset < kEnd) {
+        if (!store::Load(s_slot, offset, s_record, store::kRecordHeaderSize)) {
+            break;
+        }
+
+        const auto kEncodedLength = static_cast<uint32_t>(s_record[2] | (s_record[3] << 8));
+        const auto kLength = (store::kRecordHeaderSize + kEncodedLength + 3U) & ~3U;
+
+        if ((kEncodedLength > store::kMaxEncodedSize) || ((offset + kLength) > kEnd)) {
+            break;
+        }
+
+        if (s_record[0] == port_index) {
+            if (store::Load(s_slot, offset + store::kRecordHeaderSize, &s_record[store::kRecordHeaderSize], kLength - store::kRecordHeaderSize)) {
+                Decode(&s_record[store::kRecordHeaderSize], kEncodedLength, data);
+            }
+            DMXNODE_DEBUG_EXIT();
+            return;
+        }
+
+        offset += kLength;
+    }
+
+    // The port was not recorded
+    memset(data, 0, dmxnode::kUniverseSize);
+
+    DMXNODE_DEBUG_EXIT();
+}
+
+void ReadEnd() {
+    DMXNODE_DEBUG_ENTRY();
+
+    s_is_read_valid = false;
+    s_is_read_legacy = false;
+
+    DMXNODE_DEBUG_EXIT();
+}
+} // namespace dmxnode::scenes
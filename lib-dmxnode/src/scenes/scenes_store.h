@@ -0,0 +1,74 @@
+/**
+ * @file scenes_store.h
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef SCENES_SCENES_STORE_H_
+#define SCENES_SCENES_STORE_H_
+
+#include <cstdint>
+
+#include "dmxnode.h"
+
+/*
+ * Storage backend for the scenes (spi, rom or file).
+ *
+ * The storage holds two slots (A/B). A scene is always written into the slot
+ * that does not hold the last good scene, and its header is programmed last.
+ * A torn write therefore leaves the previous scene intact.
+ *
+ * Offsets and lengths passed to Program and Load are multiples of 4.
+ *
+ * Flash map (spi and rom), from the end of the device:
+ *
+ *   size - kSectorSize                     configuration store (lib-configstore)
+ *   size - kSectorSize - kSlotSize         slot B
+ *   size - kSectorSize - (2 * kSlotSize)   slot A
+ *
+ * Earlier firmware stored the scene raw, port_index * 512, in the kLegacySize
+ * bytes below the configuration store. That area is the end of slot B. The
+ * first scene is always written into slot A, so a legacy scene stays readable
+ * until a new scene is committed. The file backend keeps the legacy scene at
+ * the start of the file.
+ */
+namespace dmxnode::scenes::store {
+inline constexpr uint32_t kSectorSize = 4096;
+inline constexpr uint32_t kSlots = 2;
+
+inline constexpr uint32_t kHeaderSize = 16;       ///< magic, sequence, length, checksum
+inline constexpr uint32_t kRecordHeaderSize = 4;  ///< port index, reserved, encoded length (le16)
+inline constexpr uint32_t kMaxEncodedSize = dmxnode::kUniverseSize + (dmxnode::kUniverseSize / 128U) + 1U;
+inline constexpr uint32_t kMaxRecordSize = (kRecordHeaderSize + kMaxEncodedSize + 3U) & ~3U;
+inline constexpr uint32_t kSlotSize = ((kHeaderSize + dmxnode::kMaxPorts * kMaxRecordSize + kSectorSize - 1U) / kSectorSize) * kSectorSize;
+inline constexpr uint32_t kLegacySize = (1U + dmxnode::scenes::kBytesNeeded / kSectorSize) * kSectorSize;
+
+static_assert(kLegacySize <= kSlotSize);
+
+bool Init();
+bool Erase(uint32_t slot);
+bool Program(uint32_t slot, uint32_t offset, const uint8_t* data, uint32_t length);
+bool Load(uint32_t slot, uint32_t offset, uint8_t* data, uint32_t length);
+bool LoadLegacy(uint32_t offset, uint8_t* data, uint32_t length);
+} // namespace dmxnode::scenes::store
+
+#endif // SCENES_SCENES_STORE_H_
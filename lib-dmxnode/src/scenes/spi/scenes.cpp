@@ -2,7 +2,7 @@
  * @file scenes.cpp
  *
  */
-/* Copyright (C) 2025 by Arjan van Vught mailto:info@gd32-dmx.org
+/* Copyright (C) 2025-2026 by Arjan van Vught mailto:info@gd32-dmx.org
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -27,16 +27,16 @@
 #include <cassert>
 
 #include "spi/spi_flash.h"
-#include "dmxnode.h"
+#include "../scenes_store.h"
 #include "dmxnode_debug.h"
 
-namespace dmxnode::scenes {
+namespace dmxnode::scenes::store {
 static bool s_has_flash;
 static uint32_t s_offset_base;
 
-static bool CheckHaveFlash() {
+bool Init() {
     DMXNODE_DEBUG_ENTRY();
-    DMXNODE_DEBUG_PRINTF("s_hasFlash=%d", s_has_flash);
+    DMXNODE_DEBUG_PRINTF("s_has_flash=%d", s_has_flash);
 
     if (!s_has_flash) {
         if (!spi_flash_probe()) {
@@ -44,103 +44,39 @@ static bool CheckHaveFlash() {
             return false;
         }
 
-        const auto kEraseSize = spi_flash_get_sector_size();
-        assert(kEraseSize <= dmxnode::scenes::kBytesNeeded);
-        const auto kPages = 1 + (dmxnode::scenes::kBytesNeeded / kEraseSize);
-
-        DMXNODE_DEBUG_PRINTF("Bytes needed=%u, nEraseSize=%u, nPages=%u", dmxnode::scenes::kBytesNeeded, kEraseSize, kPages);
-
-        assert(((kPages + 1) * kEraseSize) <= spi_flash_get_size());
+        assert(spi_flash_get_sector_size() == kSectorSize);
+        // The last sector is kept free
+        assert(((kSlots * kSlotSize) + kSectorSize) <= spi_flash_get_size());
 
-        s_offset_base = spi_flash_get_size() - ((kPages + 1) * kEraseSize);
+        s_offset_base = spi_flash_get_size() - ((kSlots * kSlotSize) + kSectorSize);
+        s_has_flash = true;
 
-        DMXNODE_DEBUG_PRINTF("nOffsetBase=%p", s_offset_base);
+        DMXNODE_DEBUG_PRINTF("kSlotSize=%u, s_offset_base=%p", kSlotSize, s_offset_base);
     }
 
     DMXNODE_DEBUG_EXIT();
     return true;
 }
 
-void WriteStart() {
-    DMXNODE_DEBUG_ENTRY();
-    DMXNODE_DEBUG_PRINTF("s_hasFlash=%d", s_has_flash);
-
-    if (!CheckHaveFlash()) {
-        DMXNODE_DEBUG_EXIT();
-        return;
-    }
-
-    s_has_flash = spi_flash_cmd_erase(s_offset_base, spi_flash_get_sector_size());
-
-    DMXNODE_DEBUG_PRINTF("s_hasFlash=%d", s_has_flash);
-    DMXNODE_DEBUG_EXIT();
-}
-
-void Write(uint32_t port_index, const uint8_t* data) {
-    DMXNODE_DEBUG_ENTRY();
-    assert(port_index < dmxnode::kMaxPorts);
-    assert(data != nullptr);
-
-    if (!s_has_flash) {
-        DMXNODE_DEBUG_EXIT();
-        return;
-    }
-
-    const auto kOffset = s_offset_base + (port_index * dmxnode::kUniverseSize);
-
-    DMXNODE_DEBUG_PRINTF("s_offset_base=%p, kOffset=%p", s_offset_base, kOffset);
-
-    spi_flash_cmd_write_multi(kOffset, dmxnode::kUniverseSize, data);
-
-    DMXNODE_DEBUG_EXIT();
-}
-
-void WriteEnd() {
-    DMXNODE_DEBUG_ENTRY();
-
-    // No code needed here
-
-    DMXNODE_DEBUG_EXIT();
+bool Erase(uint32_t slot) {
+    assert(slot < kSlots);
+    return spi_flash_cmd_erase(s_offset_base + (slot * kSlotSize), kSlotSize);
 }
 
-void ReadStart() {
-    DMXNODE_DEBUG_ENTRY();
-    DMXNODE_DEBUG_PRINTF("s_has_flash=%d", s_has_flash);
-
-    if (!CheckHaveFlash()) {
-        DMXNODE_DEBUG_EXIT();
-        return;
-    }
-
-    s_has_flash = true;
-
-    DMXNODE_DEBUG_EXIT();
+bool Program(uint32_t slot, uint32_t offset, const uint8_t* data, uint32_t length) {
+    assert(slot < kSlots);
+    assert((offset + length) <= kSlotSize);
+    return spi_flash_cmd_write_multi(s_offset_base + (slot * kSlotSize) + offset, length, data);
 }
 
-void Read(uint32_t port_index, uint8_t* data) {
-    DMXNODE_DEBUG_ENTRY();
-    assert(port_index < dmxnode::kMaxPorts);
-    assert(data != nullptr);
-
-    if (!s_has_flash) {
-        DMXNODE_DEBUG_EXIT();
-        return;
-    }
-
-    const auto kOffset = s_offset_base + (port_index * dmxnode::kUniverseSize);
-
-    DMXNODE_DEBUG_PRINTF("s_offset_base=%p, kOffset=%u", reinterpret_cast<void*>(s_offset_base), static_cast<unsigned>(kOffset));
-
-    spi_flash_cmd_read_fast(kOffset, dmxnode::kUniverseSize, data);
-
-    DMXNODE_DEBUG_EXIT();
+bool Load(uint32_t slot, uint32_t offset, uint8_t* data, uint32_t length) {
+    assert(slot < kSlots);
+    assert((offset + length) <= kSlotSize);
+    return spi_flash_cmd_read_fast(s_offset_base + (slot * kSlotSize) + offset, length, data);
 }
 
-void ReadEnd() {
-    DMXNODE_DEBUG_ENTRY();
-
-    // No code needed here
-
-    DMXNODE_DEBUG_EXIT();
+bool LoadLegacy(uint32_t offset, uint8_t* data, uint32_t length) {
+    // The legacy area ends where slot B ends
+    return Load(1, kSlotSize - kLegacySize + offset, data, length);
 }
-} // namespace dmxnode::scenes
+} // namespace dmxnode::scenes::store
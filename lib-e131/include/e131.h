@@ -66,6 +66,11 @@ inline constexpr uint8_t kLowest = 1;
 inline constexpr uint8_t kDefault = 100;
 inline constexpr uint8_t kHighest = 200;
 } // namespace priority
+namespace startcode
+{
+inline constexpr uint8_t kNull = 0x00;
+inline constexpr uint8_t kPerAddressPriority = 0xDD; ///< One priority per slot, 0 means the slot is not sourced
+} // namespace startcode
 namespace vector
 {
 namespace root
@@ -26,6 +26,7 @@
 #define E131BRIDGE_H_
 
 #include <cstdint>
+#include <bit>
 
 #include "dmxnode.h"
 #include "e131.h"
@@ -41,6 +42,17 @@
 #endif
 
 namespace e131bridge {
+/**
+ * Maximum number of sources tracked per output port.
+ * Each source has its own data buffer in dmxnode::Data.
+ */
+inline constexpr uint32_t kMaxSources = dmxnode::kMergeSources;
+/**
+ * The source lookup is an open addressing table on the cid hash, at most half full.
+ */
+inline constexpr uint32_t kSourceIndexSize = std::bit_ceil(2U * kMaxSources);
+inline constexpr uint32_t kMaxSynchronizationAddresses = dmxnode::kMaxPorts * kMaxSources;
+
 enum class Status : uint8_t { kOff, kStandby, kOn };
 
 enum StateFlags : uint8_t { kNetworkDataLoss = (1 << 0), kMergeMode = (1 << 1), kSynchronized = (1 << 2), kForcedSynchronized = (1 << 3), kChanged = (1 << 4), kDisableMergeTimeout = (1 << 5), kDisableSynchronize = (1 << 6) };
@@ -48,13 +60,10 @@ enum StateFlags : uint8_t { kNetworkDataLoss = (1 << 0), kMergeMode = (1 << 1),
 struct State {
     uint8_t enabled_input_ports;
     uint8_t enabled_output_ports;
-    uint8_t priority;
     uint8_t receiving_dmx;
     dmxnode::FailSafe failsafe;
     e131bridge::Status status;
     uint16_t discovery_packet_length;
-    uint16_t synchronization_address_source_a;
-    uint16_t synchronization_address_source_b;
     uint32_t synchronization_time;
     bool is_network_data_loss;
     bool is_merge_mode;
@@ -76,13 +85,27 @@ struct Bridge {
 struct Source {
     uint32_t millis;
     uint32_t ip;
+    uint32_t cid_hash;
     uint8_t cid[e117::kCidLength];
+    uint16_t synchronization_address; ///< 0 when the source does not synchronize
     uint8_t sequence_number_data;
+    uint8_t priority;
 };
 
+/*
+ * The winning sources are the active sources with the highest priority.
+ * They are only recomputed when a source is added, removed, times out
+ * or changes its priority.
+ */
 struct OutputPort {
-    Source source_a ALIGNED;
-    Source source_b ALIGNED;
+    Source source[kMaxSources] ALIGNED;
+    uint8_t source_index[kSourceIndexSize]; ///< Index into source[], kMaxSources when empty
+    uint16_t active_sources;  ///< Bit mask, index into source[]
+    uint16_t winning_sources; ///< Bit mask, index into source[]
+    uint8_t winning_priority;
+#if defined(CONFIG_DMXNODE_SLOT_PRIORITY)
+    uint16_t slot_priority_sources; ///< Bit mask, sources sending start code 0xDD
+#endif
     dmxnode::MergeMode merge_mode;
     dmxnode::OutputStyle output_style;
     bool is_merging;
@@ -90,6 +113,15 @@ struct OutputPort {
     bool is_data_pending;
 };
 
+/*
+ * Number of active sources synchronizing on an address.
+ * The multicast group is joined for the first and left after the last.
+ */
+struct Synchronization {
+    uint16_t address;
+    uint16_t count;
+};
+
 struct InputPort {
     uint32_t multicast_ip;
     uint32_t millis;
@@ -195,14 +227,22 @@ class E131Bridge
    private:
     void InputUdp(const uint8_t* buffer, uint32_t size, uint32_t from_ip, uint16_t from_port);
 
-    void SetNetworkDataLossCondition(bool source_a = true, bool source_b = true);
+    void SetNetworkDataLossCondition();
+    void SetSourceTerminated(uint32_t port_index, uint32_t source_index);
+    void FailSafe();
 
-    void SetSynchronizationAddress(bool source_a, bool source_b, uint16_t synchronization_address);
+    void SetSynchronizationAddress(uint32_t port_index, uint32_t source_index, uint16_t synchronization_address);
+    void AddSynchronizationAddress(uint16_t synchronization_address);
+    void RemoveSynchronizationAddress(uint16_t synchronization_address);
+    bool IsSynchronizationAddress(uint16_t synchronization_address) const;
+    bool HasSynchronizationSource() const;
 
-    void CheckMergeTimeouts(uint32_t port_index);
-    bool IsPriorityTimeOut(uint32_t port_index) const;
-    bool IsIpCidMatch(const e131bridge::Source* const kSource) const;
-    void UpdateMergeStatus(uint32_t port_index);
+    uint32_t FindSource(uint32_t port_index, uint32_t cid_hash) const;
+    uint32_t AddSource(uint32_t port_index, uint32_t cid_hash, uint8_t priority);
+    void RemoveSource(uint32_t port_index, uint32_t source_index);
+    bool CheckSourceTimeouts(uint32_t port_index);
+    void UpdateWinningSources(uint32_t port_index);
+    void UpdateMergeStatus();
 
     void HandleDmx();
     void HandleSynchronization();
@@ -232,6 +272,7 @@ class E131Bridge
     e131bridge::Bridge bridge_;
     e131bridge::OutputPort output_port_[dmxnode::kMaxPorts];
     e131bridge::InputPort input_port_[dmxnode::kMaxPorts];
+    e131bridge::Synchronization synchronization_[e131bridge::kMaxSynchronizationAddresses];
 
     bool enable_data_indicator_{true};
 
@@ -51,6 +51,17 @@
 #include "board_statusled.h"
 #include "board.h"
 #include "firmware/debug/debug_debug.h"
+#include "firmware/debug/debug_profile.h"
+
+// Only data packets are handled in the EMAC receive buffer
+static bool IsZeroCopy(const uint8_t* buffer, uint32_t size) {
+    if (size < e117::kRootLayerSize) {
+        return false;
+    }
+
+    const auto* const kRaw = reinterpret_cast<const e131::RawPacket*>(buffer);
+    return kRaw->root_layer.vector == __builtin_bswap32(e131::vector::root::kData);
+}
 
 E131Bridge::E131Bridge() {
     DEBUG_ENTRY();
@@ -65,11 +76,12 @@ E131Bridge::E131Bridge() {
     }
 
     memset(&state_, 0, sizeof(e131bridge::State));
-    state_.priority = e131::priority::kLowest;
+    memset(synchronization_, 0, sizeof(synchronization_));
     state_.failsafe = dmxnode::FailSafe::kHold;
 
     for (uint32_t i = 0; i < dmxnode::kMaxPorts; i++) {
         memset(&output_port_[i], 0, sizeof(e131bridge::OutputPort));
+        memset(output_port_[i].source_index, e131bridge::kMaxSources, sizeof(output_port_[i].source_index));
         memset(&input_port_[i], 0, sizeof(e131bridge::InputPort));
         input_port_[i].priority = 100;
     }
@@ -83,7 +95,7 @@ E131Bridge::E131Bridge() {
     UuidCopy(cid_);
 #endif
 
-    handle_ = network::udp::Begin(e131::kUdpPort, E131Bridge::StaticCallbackFunctionUdp);
+    handle_ = network::udp::Begin(e131::kUdpPort, E131Bridge::StaticCallbackFunctionUdp, IsZeroCopy);
     assert(handle_ != -1);
 
     SetLongName(nullptr); // Set default long name
@@ -169,40 +181,91 @@ void E131Bridge::Stop() {
     board::statusled::SetMode(board::statusled::Mode::kOffOff);
 }
 
-void E131Bridge::SetSynchronizationAddress(bool source_a, bool source_b, uint16_t synchronization_address) {
+void E131Bridge::SetSynchronizationAddress(uint32_t port_index, uint32_t source_index, uint16_t synchronization_address) {
+    assert(port_index < dmxnode::kMaxPorts);
+    assert(source_index < e131bridge::kMaxSources);
+    assert(synchronization_address != 0);
+
+    auto& source = output_port_[port_index].source[source_index];
+
+    if (source.synchronization_address == synchronization_address) {
+        return;
+    }
+
     DEBUG_ENTRY();
-    DEBUG_PRINTF("source_a=%d, source_b=%d, synchronization_address=%d", static_cast<unsigned>(source_a), static_cast<unsigned>(source_b), static_cast<unsigned>(synchronization_address));
+    DEBUG_PRINTF("port_index=%u, source_index=%u, synchronization_address=%u", static_cast<unsigned>(port_index), static_cast<unsigned>(source_index), static_cast<unsigned>(synchronization_address));
 
-    assert(synchronization_address != 0);
+    const auto kPrevious = source.synchronization_address;
+    source.synchronization_address = synchronization_address;
 
-    uint16_t* synchronization_address_source;
+    AddSynchronizationAddress(synchronization_address);
 
-    if (source_a) {
-        synchronization_address_source = &state_.synchronization_address_source_a;
-    } else if (source_b) {
-        synchronization_address_source = &state_.synchronization_address_source_b;
-    } else {
-        DEBUG_EXIT();
-        return; // Just make the compiler happy
+    if (kPrevious != 0) {
+        RemoveSynchronizationAddress(kPrevious);
     }
 
-    if (*synchronization_address_source == 0) {
-        *synchronization_address_source = synchronization_address;
-        DEBUG_PUTS("synchronization_address_source == 0");
-    } else if (*synchronization_address_source != synchronization_address) {
-        // dmxnode::kMaxPorts forces to check all ports
-        LeaveUniverse(dmxnode::kMaxPorts, *synchronization_address_source);
-        *synchronization_address_source = synchronization_address;
-        DEBUG_PUTS("synchronization_address_source != synchronization_address");
-    } else {
-        DEBUG_PUTS("Already received synchronization_address");
-        DEBUG_EXIT();
-        return;
+    DEBUG_EXIT();
+}
+
+void E131Bridge::AddSynchronizationAddress(uint16_t synchronization_address) {
+    e131bridge::Synchronization* free = nullptr;
+
+    for (auto& synchronization : synchronization_) {
+        if (synchronization.count == 0) {
+            if (free == nullptr) {
+                free = &synchronization;
+            }
+        } else if (synchronization.address == synchronization_address) {
+            synchronization.count++;
+            return;
+        }
     }
 
-    network::igmp::JoinGroup(handle_, e131::UniverseToMulticastIp(synchronization_address));
+    // There is an entry for each source
+    assert(free != nullptr);
 
-    DEBUG_EXIT();
+    // Join before counting, a port may already have joined the universe
+    JoinUniverse(dmxnode::kMaxPorts, synchronization_address);
+
+    free->address = synchronization_address;
+    free->count = 1;
+}
+
+void E131Bridge::RemoveSynchronizationAddress(uint16_t synchronization_address) {
+    for (auto& synchronization : synchronization_) {
+        if ((synchronization.count != 0) && (synchronization.address == synchronization_address)) {
+            if (--synchronization.count == 0) {
+                // dmxnode::kMaxPorts forces to check all ports
+                LeaveUniverse(dmxnode::kMaxPorts, synchronization_address);
+            }
+            return;
+        }
+    }
+
+    assert(false);
+}
+
+/**
+ * @return true when an active source on any port synchronizes on this address
+ */
+bool E131Bridge::IsSynchronizationAddress(uint16_t synchronization_address) const {
+    for (const auto& synchronization : synchronization_) {
+        if ((synchronization.count != 0) && (synchronization.address == synchronization_address)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool E131Bridge::HasSynchronizationSource() const {
+    for (const auto& synchronization : synchronization_) {
+        if (synchronization.count != 0) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 void E131Bridge::JoinUniverse(uint32_t port_index, uint16_t universe) {
@@ -224,6 +287,11 @@ void E131Bridge::JoinUniverse(uint32_t port_index, uint16_t universe) {
         }
     }
 
+    if (IsSynchronizationAddress(universe)) {
+        DEBUG_EXIT();
+        return;
+    }
+
     DEBUG_PUTS("Join");
     network::igmp::JoinGroup(handle_, e131::UniverseToMulticastIp(universe));
 
@@ -249,6 +317,11 @@ void E131Bridge::LeaveUniverse(uint32_t port_index, uint16_t universe) {
         }
     }
 
+    if (IsSynchronizationAddress(universe)) {
+        DEBUG_EXIT();
+        return;
+    }
+
     DEBUG_PUTS("Leave");
     network::igmp::LeaveGroup(handle_, e131::UniverseToMulticastIp(universe));
 
@@ -273,15 +346,8 @@ void E131Bridge::SetLocalMerging() {
             DEBUG_PRINTF("input_port_index=%u %u, output_port_index=%u %u", static_cast<unsigned>(input_port_index), static_cast<unsigned>(bridge_.port[input_port_index].universe), static_cast<unsigned>(output_port_index), static_cast<unsigned>(bridge_.port[output_port_index].universe));
 
             if (bridge_.port[input_port_index].universe == bridge_.port[output_port_index].universe) {
-                if (!bridge_.port[output_port_index].local_merge) {
-                    output_port_[output_port_index].source_a.ip = network::kIpaddrLoopback;
-                    DEBUG_PUTS("Local merge Source A");
-                } else {
-                    output_port_[output_port_index].source_b.ip = network::kIpaddrLoopback;
-                    DEBUG_PUTS("Local merge Source B");
-                }
-
-                DEBUG_PUTS("");
+                // The local input is just another source in the table of the output port
+                DEBUG_PUTS("Local merge");
                 bridge_.port[input_port_index].local_merge = true;
                 bridge_.port[output_port_index].local_merge = true;
             }
@@ -494,7 +560,7 @@ void E131Bridge::HandleSynchronization() {
     const auto& synchronization_packet = *reinterpret_cast<const e131::SynchronizationPacket*>(receive_buffer_);
     const auto kSynchronizationAddress = __builtin_bswap16(synchronization_packet.frame_layer.universe_number);
 
-    if ((kSynchronizationAddress != state_.synchronization_address_source_a) && (kSynchronizationAddress != state_.synchronization_address_source_b)) {
+    if ((kSynchronizationAddress == 0) || !IsSynchronizationAddress(kSynchronizationAddress)) {
         board::statusled::SetMode(board::statusled::Mode::kNormal);
         DEBUG_PUTS("");
         return;
@@ -565,85 +631,230 @@ void E131Bridge::InputUdp(const uint8_t* buffer, [[maybe_unused]] uint32_t size,
     panelled::On(panelled::kSacn);
 }
 
-void E131Bridge::UpdateMergeStatus(uint32_t port_index) {
-    if (!state_.is_merge_mode) {
-        state_.is_merge_mode = true;
+static uint32_t CidHash(const uint8_t* cid) {
+    uint32_t word[e117::kCidLength / 4];
+    memcpy(word, cid, sizeof(word));
+    return word[0] ^ word[1] ^ word[2] ^ word[3];
+}
+
+static constexpr uint32_t SourceSlot(uint32_t cid_hash) {
+    // Fibonacci hashing, the top bits index the table
+    return (cid_hash * 2654435761U) >> (32 - std::countr_zero(e131bridge::kSourceIndexSize));
+}
+
+static void IndexSource(e131bridge::OutputPort& output_port, uint32_t source_index) {
+    auto slot = SourceSlot(output_port.source[source_index].cid_hash);
+
+    while (output_port.source_index[slot] != e131bridge::kMaxSources) {
+        slot = (slot + 1) & (e131bridge::kSourceIndexSize - 1);
+    }
+
+    output_port.source_index[slot] = static_cast<uint8_t>(source_index);
+}
+
+void E131Bridge::UpdateMergeStatus() {
+    auto is_merging = false;
+
+    for (const auto& output_port : output_port_) {
+        is_merging |= output_port.is_merging;
+    }
+
+    if (state_.is_merge_mode != is_merging) {
+        state_.is_merge_mode = is_merging;
         state_.is_changed = true;
     }
+}
 
-    output_port_[port_index].is_merging = true;
+/**
+ * @return source index, e131bridge::kMaxSources when not found
+ */
+uint32_t E131Bridge::FindSource(uint32_t port_index, uint32_t cid_hash) const {
+    assert(port_index < dmxnode::kMaxPorts);
+
+    const auto& output_port = output_port_[port_index];
+    const auto& raw = *reinterpret_cast<const e131::RawPacket*>(receive_buffer_);
+
+    // The table is at most half full, there is always an empty slot
+    for (auto slot = SourceSlot(cid_hash);; slot = (slot + 1) & (e131bridge::kSourceIndexSize - 1)) {
+        const auto kIndex = output_port.source_index[slot];
+
+        if (kIndex == e131bridge::kMaxSources) {
+            return e131bridge::kMaxSources;
+        }
+
+        const auto& source = output_port.source[kIndex];
+
+        if ((source.cid_hash == cid_hash) && (memcmp(source.cid, raw.root_layer.cid, e117::kCidLength) == 0)) {
+            return kIndex;
+        }
+    }
 }
 
-void E131Bridge::CheckMergeTimeouts(uint32_t port_index) {
+/**
+ * When the table is full, the lowest priority source is replaced,
+ * but only when it has a lower priority than the new source.
+ * @return source index, e131bridge::kMaxSources when there is no room
+ */
+uint32_t E131Bridge::AddSource(uint32_t port_index, uint32_t cid_hash, uint8_t priority) {
     assert(port_index < dmxnode::kMaxPorts);
 
-    const auto kTimeOutA = current_millis_ - output_port_[port_index].source_a.millis;
+    auto& output_port = output_port_[port_index];
+    const auto kFree = ~static_cast<uint32_t>(output_port.active_sources) & ((1U << e131bridge::kMaxSources) - 1U);
+    uint32_t index;
 
-    if (kTimeOutA > (e131::kMergeTimeoutSeconds * 1000U)) {
-        output_port_[port_index].source_a.ip = 0;
-        memset(output_port_[port_index].source_a.cid, 0, e117::kCidLength);
-        output_port_[port_index].is_merging = false;
+    if (kFree != 0) {
+        index = static_cast<uint32_t>(__builtin_ctz(kFree));
+    } else {
+        index = e131bridge::kMaxSources;
+        auto lowest = priority;
+
+        for (uint32_t i = 0; i < e131bridge::kMaxSources; i++) {
+            if (output_port.source[i].priority < lowest) {
+                lowest = output_port.source[i].priority;
+                index = i;
+            }
+        }
+
+        if (index == e131bridge::kMaxSources) {
+            return index;
+        }
+
+        DEBUG_PRINTF("port_index=%u, replacing source %u", static_cast<unsigned>(port_index), static_cast<unsigned>(index));
+
+        RemoveSource(port_index, index);
     }
 
-    const auto kTimeOutB = current_millis_ - output_port_[port_index].source_b.millis;
+    const auto& raw = *reinterpret_cast<const e131::RawPacket*>(receive_buffer_);
+    auto& source = output_port.source[index];
+
+    source.millis = packet_millis_;
+    source.ip = ip_address_from_;
+    source.cid_hash = cid_hash;
+    memcpy(source.cid, raw.root_layer.cid, e117::kCidLength);
+    source.priority = priority;
+    source.synchronization_address = 0;
+
+    output_port.active_sources = static_cast<uint16_t>(output_port.active_sources | (1U << index));
+
+    IndexSource(output_port, index);
+
+    return index;
+}
+
+void E131Bridge::RemoveSource(uint32_t port_index, uint32_t source_index) {
+    assert(port_index < dmxnode::kMaxPorts);
+    assert(source_index < e131bridge::kMaxSources);
+
+    auto& output_port = output_port_[port_index];
+
+    output_port.active_sources = static_cast<uint16_t>(output_port.active_sources & ~(1U << source_index));
+#if defined(CONFIG_DMXNODE_SLOT_PRIORITY)
+    output_port.slot_priority_sources = static_cast<uint16_t>(output_port.slot_priority_sources & ~(1U << source_index));
+#endif
+    auto& source = output_port.source[source_index];
+
+    source.ip = 0;
+    source.cid_hash = 0;
+    memset(source.cid, 0, e117::kCidLength);
 
-    if (kTimeOutB > (e131::kMergeTimeoutSeconds * 1000U)) {
-        output_port_[port_index].source_b.ip = 0;
-        memset(output_port_[port_index].source_b.cid, 0, e117::kCidLength);
-        output_port_[port_index].is_merging = false;
+    // Removing from open addressing breaks the probe chains, rebuild the few entries
+    memset(output_port.source_index, e131bridge::kMaxSources, sizeof(output_port.source_index));
+
+    uint32_t sources = output_port.active_sources;
+
+    while (sources != 0) {
+        IndexSource(output_port, static_cast<uint32_t>(__builtin_ctz(sources)));
+        sources &= sources - 1U;
     }
 
-    auto is_merging = false;
+    const auto kSynchronizationAddress = source.synchronization_address;
 
-    for (uint32_t i = 0; i < dmxnode::kMaxPorts; i++) {
-        is_merging |= output_port_[i].is_merging;
+    if (kSynchronizationAddress == 0) {
+        return;
     }
 
-    if (!is_merging) {
-        state_.is_changed = true;
-        state_.is_merge_mode = false;
+    source.synchronization_address = 0;
+
+    RemoveSynchronizationAddress(kSynchronizationAddress);
+
+    // The last synchronizing source is gone, do not wait for synchronization packets any longer
+    if (!HasSynchronizationSource()) {
+        state_.is_forced_synchronized = false;
     }
 }
 
-bool E131Bridge::IsPriorityTimeOut(uint32_t port_index) const {
+/**
+ * Sources not heard of for kMergeTimeoutSeconds are removed.
+ * With merge timeout disabled, the sources being merged are kept.
+ * @return true when a source was removed
+ */
+bool E131Bridge::CheckSourceTimeouts(uint32_t port_index) {
     assert(port_index < dmxnode::kMaxPorts);
 
-    const auto kTimeOutA = current_millis_ - output_port_[port_index].source_a.millis;
-    const auto kTimeOutB = current_millis_ - output_port_[port_index].source_b.millis;
+    const auto& output_port = output_port_[port_index];
+    uint32_t sources = output_port.active_sources;
+    auto is_removed = false;
 
-    if ((output_port_[port_index].source_a.ip != 0) && (output_port_[port_index].source_b.ip != 0)) {
-        if ((kTimeOutA < (e131::kPriorityTimeoutSeconds * 1000U)) || (kTimeOutB < (e131::kPriorityTimeoutSeconds * 1000U))) {
-            return false;
-        } else {
-            return true;
-        }
-    } else if ((output_port_[port_index].source_a.ip != 0) && (output_port_[port_index].source_b.ip == 0)) {
-        if (kTimeOutA > (e131::kPriorityTimeoutSeconds * 1000U)) {
-            return true;
-        }
-    } else if ((output_port_[port_index].source_a.ip == 0) && (output_port_[port_index].source_b.ip != 0)) {
-        if (kTimeOutB > (e131::kPriorityTimeoutSeconds * 1000U)) {
-            return true;
+    if (__builtin_expect((state_.disable_merge_timeout && output_port.is_merging), 0)) {
+        sources &= ~static_cast<uint32_t>(output_port.winning_sources);
+    }
+
+    while (sources != 0) {
+        const auto kIndex = static_cast<uint32_t>(__builtin_ctz(sources));
+        sources &= sources - 1U;
+
+        if ((packet_millis_ - output_port.source[kIndex].millis) > (e131::kMergeTimeoutSeconds * 1000U)) {
+            RemoveSource(port_index, kIndex);
+            is_removed = true;
         }
     }
 
-    return false;
+    return is_removed;
 }
 
-bool E131Bridge::IsIpCidMatch(const e131bridge::Source* const kSource) const {
-    if (kSource->ip != ip_address_from_) {
-        return false;
+/**
+ * The winning sources are the active sources with the highest priority.
+ * More than one winning source means merging.
+ */
+void E131Bridge::UpdateWinningSources(uint32_t port_index) {
+    assert(port_index < dmxnode::kMaxPorts);
+
+    auto& output_port = output_port_[port_index];
+    uint32_t sources = output_port.active_sources;
+    uint32_t winning_sources = 0;
+    uint8_t winning_priority = 0;
+
+    while (sources != 0) {
+        const auto kIndex = static_cast<uint32_t>(__builtin_ctz(sources));
+        sources &= sources - 1U;
+
+        const auto kPriority = output_port.source[kIndex].priority;
+
+        if ((kPriority > winning_priority) || (winning_sources == 0)) {
+            winning_priority = kPriority;
+            winning_sources = (1U << kIndex);
+        } else if (kPriority == winning_priority) {
+            winning_sources |= (1U << kIndex);
+        }
     }
 
-    const auto& raw = *reinterpret_cast<const e131::RawPacket*>(receive_buffer_);
+    output_port.winning_sources = static_cast<uint16_t>(winning_sources);
+    output_port.winning_priority = winning_priority;
+
+    const auto kIsMerging = ((winning_sources & (winning_sources - 1U)) != 0);
 
-    return memcmp(kSource->cid, raw.root_layer.cid, e117::kCidLength) == 0;
+    if (output_port.is_merging != kIsMerging) {
+        output_port.is_merging = kIsMerging;
+        UpdateMergeStatus();
+    }
 }
 
 void E131Bridge::HandleDmx() {
+    DEBUG_PROFILE_SCOPE(kE131HandleDmx);
     const auto& data = *reinterpret_cast<const e131::DataPacket*>(receive_buffer_);
     const auto* const kDmxData = &data.dmp_layer.property_values[1];
     const auto kDmxSlots = __builtin_bswap16(data.dmp_layer.property_value_count) - 1U;
+    const auto kCidHash = CidHash(data.root_layer.cid);
 
     for (uint32_t port_index = 0; port_index < dmxnode::kMaxPorts; port_index++) {
         if (bridge_.port[port_index].direction == dmxnode::Direction::kOutput) {
@@ -655,28 +866,19 @@ void E131Bridge::HandleDmx() {
                 continue;
             }
 
-            auto& source_a = output_port_[port_index].source_a;
-            auto& source_b = output_port_[port_index].source_b;
-
-            const auto kIpA = source_a.ip;
-            const auto kIpB = source_b.ip;
+            auto& output_port = output_port_[port_index];
 
-            const auto kIsSourceA = IsIpCidMatch(&source_a);
-            const auto kIsSourceB = IsIpCidMatch(&source_b);
+            auto is_changed = CheckSourceTimeouts(port_index);
+            auto source_index = FindSource(port_index, kCidHash);
 
             // 6.9.2 Sequence Numbering
             // Having first received a packet with sequence number A, a second packet with sequence number B
             // arrives. If, using signed 8-bit binary arithmetic, B – A is less than or equal to 0, but greater than -20 then
             // the packet containing sequence number B shall be deemed out of sequence and discarded
-            if (kIsSourceA) {
-                const auto kDiff = static_cast<int8_t>(data.frame_layer.sequence_number - source_a.sequence_number_data);
-                source_a.sequence_number_data = data.frame_layer.sequence_number;
-                if ((kDiff <= 0) && (kDiff > -20)) {
-                    continue;
-                }
-            } else if (kIsSourceB) {
-                const auto kDiff = static_cast<int8_t>(data.frame_layer.sequence_number - source_b.sequence_number_data);
-                source_b.sequence_number_data = data.frame_layer.sequence_number;
+            if (source_index != e131bridge::kMaxSources) {
+                auto& source = output_port.source[source_index];
+                const auto kDiff = static_cast<int8_t>(data.frame_layer.sequence_number - source.sequence_number_data);
+                source.sequence_number_data = data.frame_layer.sequence_number;
                 if ((kDiff <= 0) && (kDiff > -20)) {
                     continue;
                 }
@@ -691,88 +893,70 @@ void E131Bridge::HandleDmx() {
             // Upon receipt of a packet containing this bit set to a value of 1, receiver shall enter network data loss condition.
             // Any property values in these packets shall be ignored.
             if (e131::OptionsMask::Has(data.frame_layer.options, e131::OptionsMask::Mask::kStreamTerminated)) {
-                if (kIsSourceA || kIsSourceB) {
-                    SetNetworkDataLossCondition(kIsSourceA, kIsSourceB);
+                if (source_index != e131bridge::kMaxSources) {
+                    SetSourceTerminated(port_index, source_index);
                 }
                 continue;
             }
 
-            if (state_.is_merge_mode) {
-                if (__builtin_expect((!state_.disable_merge_timeout), 1)) {
-                    CheckMergeTimeouts(port_index);
-                }
-            }
+            const auto kPriority = data.frame_layer.priority;
+
+            if (source_index == e131bridge::kMaxSources) {
+                source_index = AddSource(port_index, kCidHash, kPriority);
 
-            if (data.frame_layer.priority < state_.priority) {
-                if (!IsPriorityTimeOut(port_index)) {
+                if (source_index == e131bridge::kMaxSources) {
+                    DEBUG_PUTS("Source table full");
                     continue;
                 }
-                state_.priority = data.frame_layer.priority;
-            } else if (data.frame_layer.priority > state_.priority) {
-                output_port_[port_index].source_a.ip = 0;
-                output_port_[port_index].source_b.ip = 0;
-                state_.is_merge_mode = false;
-                state_.priority = data.frame_layer.priority;
+
+                output_port.source[source_index].sequence_number_data = data.frame_layer.sequence_number;
+                is_changed = true;
+            } else if (output_port.source[source_index].priority != kPriority) {
+                output_port.source[source_index].priority = kPriority;
+                is_changed = true;
             }
 
-            if ((kIpA == 0) && (kIpB == 0)) {
-                // printf("1. First package from Source\n");
-                source_a.ip = ip_address_from_;
-                source_a.sequence_number_data = data.frame_layer.sequence_number;
-                memcpy(source_a.cid, data.root_layer.cid, 16);
-                source_a.millis = packet_millis_;
-                dmxnode::Data::SetSourceA(port_index, kDmxData, kDmxSlots);
-            } else if (kIsSourceA && (kIpB == 0)) {
-                // printf("2. Continue package from SourceA\n");
-                source_a.sequence_number_data = data.frame_layer.sequence_number;
-                source_a.millis = packet_millis_;
-                dmxnode::Data::SetSourceA(port_index, kDmxData, kDmxSlots);
-            } else if ((kIpA == 0) && kIsSourceB) {
-                // printf("3. Continue package from source_b\n");
-                source_b.sequence_number_data = data.frame_layer.sequence_number;
-                source_b.millis = packet_millis_;
-                dmxnode::Data::SetSourceB(port_index, kDmxData, kDmxSlots);
-            } else if (!kIsSourceA && (kIpB == 0)) {
-                // printf("4. New ip, start merging\n");
-                source_b.ip = ip_address_from_;
-                source_b.sequence_number_data = data.frame_layer.sequence_number;
-                memcpy(source_b.cid, data.root_layer.cid, 16);
-                source_b.millis = packet_millis_;
-                UpdateMergeStatus(port_index);
-                dmxnode::Data::MergeSourceB(port_index, kDmxData, kDmxSlots, output_port_[port_index].merge_mode);
-            } else if ((kIpA == 0) && !kIsSourceB) {
-                // printf("5. New ip, start merging\n");
-                source_a.ip = ip_address_from_;
-                source_a.sequence_number_data = data.frame_layer.sequence_number;
-                memcpy(source_a.cid, data.root_layer.cid, 16);
-                source_a.millis = packet_millis_;
-                UpdateMergeStatus(port_index);
-                dmxnode::Data::MergeSourceA(port_index, kDmxData, kDmxSlots, output_port_[port_index].merge_mode);
-            } else if (kIsSourceA && !kIsSourceB) {
-                // printf("6. Continue merging\n");
-                source_a.sequence_number_data = data.frame_layer.sequence_number;
-                source_a.millis = packet_millis_;
-                UpdateMergeStatus(port_index);
-                dmxnode::Data::MergeSourceA(port_index, kDmxData, kDmxSlots, output_port_[port_index].merge_mode);
-            } else if (!kIsSourceA && kIsSourceB) {
-                // printf("7. Continue merging\n");
-                source_b.sequence_number_data = data.frame_layer.sequence_number;
-                source_b.millis = packet_millis_;
-                UpdateMergeStatus(port_index);
-                dmxnode::Data::MergeSourceB(port_index, kDmxData, kDmxSlots, output_port_[port_index].merge_mode);
+            output_port.source[source_index].millis = packet_millis_;
+
+            if (is_changed) {
+                UpdateWinningSources(port_index);
             }
-#ifndef NDEBUG
-            else if (kIsSourceA && kIsSourceB) {
-                puts("WARN: 8. Source matches both ip, discarding data");
-                return;
-            } else if (!kIsSourceA && !kIsSourceB) {
-                puts("WARN: 9. More than two sources, discarding data");
-                return;
-            } else {
-                puts("ERROR: 0. No cases matched, this shouldn't happen!");
-                return;
+
+            const auto kStartCode = data.dmp_layer.property_values[0];
+
+#if defined(CONFIG_DMXNODE_SLOT_PRIORITY)
+            if (kStartCode == e131::startcode::kPerAddressPriority) {
+                output_port.slot_priority_sources = static_cast<uint16_t>(output_port.slot_priority_sources | (1U << source_index));
+                dmxnode::Data::SetSlotPriority(port_index, source_index, kDmxData, kDmxSlots);
+                continue;
             }
 #endif
+
+            // Alternate start codes are not for the DMX output
+            if (kStartCode != e131::startcode::kNull) {
+                continue;
+            }
+
+#if defined(CONFIG_DMXNODE_SLOT_PRIORITY)
+            // As soon as one source sends per slot priorities, all active sources take part per slot
+            if (output_port.slot_priority_sources != 0) {
+                if ((output_port.slot_priority_sources & (1U << source_index)) == 0) {
+                    dmxnode::Data::SetSlotPriority(port_index, source_index, output_port.source[source_index].priority);
+                }
+                dmxnode::Data::MergeSlotPriority(port_index, source_index, kDmxData, kDmxSlots, output_port.active_sources);
+            } else if ((output_port.winning_sources & (1U << source_index)) == 0) {
+#else
+            if ((output_port.winning_sources & (1U << source_index)) == 0) {
+#endif
+                // Lower priority, keep the data for when this source takes over
+                dmxnode::Data::StoreSource(port_index, source_index, kDmxData, kDmxSlots);
+                continue;
+            } else if (output_port.is_merging) {
+                dmxnode::Data::MergeSource(port_index, source_index, kDmxData, kDmxSlots, output_port.merge_mode, output_port.winning_sources);
+            } else {
+                dmxnode::Data::SetSource(port_index, source_index, kDmxData, kDmxSlots);
+            }
+
             // This bit indicates whether to lock or revert to an unsynchronized state when synchronization is lost
             // (See Section 11 on Universe Synchronization and 11.1 for discussion on synchronization states).
             // When set to 0, components that had been operating in a synchronized state shall not update with any
@@ -790,13 +974,9 @@ void E131Bridge::HandleDmx() {
 
                 // Synchronization is required: enter synchronized state (until sync is lost or overridden)
                 if (data.frame_layer.synchronization_address != 0) {
+                    SetSynchronizationAddress(port_index, source_index, __builtin_bswap16(data.frame_layer.synchronization_address));
+
                     if (!state_.is_forced_synchronized) {
-                        // Decide which source triggered the sync request
-                        if (!(kIsSourceA || kIsSourceB)) {
-                            SetSynchronizationAddress((source_a.ip != 0), (source_b.ip != 0), __builtin_bswap16(data.frame_layer.synchronization_address));
-                        } else {
-                            SetSynchronizationAddress(kIsSourceA, kIsSourceB, __builtin_bswap16(data.frame_layer.synchronization_address));
-                        }
                         state_.is_forced_synchronized = true;
                         state_.is_synchronized = true;
                     }
@@ -826,71 +1006,85 @@ void E131Bridge::HandleDmx() {
     }
 }
 
-void E131Bridge::SetNetworkDataLossCondition(bool source_a, bool source_b) {
+void E131Bridge::FailSafe() {
+    switch (state_.failsafe) {
+        case dmxnode::FailSafe::kHold:
+            break;
+        case dmxnode::FailSafe::kOff:
+            dmxnode_output_type_->Blackout(true);
+            break;
+        case dmxnode::FailSafe::kOn:
+            dmxnode_output_type_->FullOn();
+            break;
+        default:
+            DEBUG_PRINTF("state_.failsafe=%u", static_cast<unsigned>(state_.failsafe));
+            assert(false && "Invalid state_.failsafe");
+            break;
+    }
+}
+
+void E131Bridge::SetSourceTerminated(uint32_t port_index, uint32_t source_index) {
     DEBUG_ENTRY();
-    DEBUG_PRINTF("%u %u", static_cast<unsigned>(source_a), static_cast<unsigned>(source_b));
+    DEBUG_PRINTF("port_index=%u, source_index=%u", static_cast<unsigned>(port_index), static_cast<unsigned>(source_index));
+
+    RemoveSource(port_index, source_index);
+    UpdateWinningSources(port_index);
+
+    auto& output_port = output_port_[port_index];
+
+    if ((output_port.active_sources != 0) || !output_port.is_transmitting) {
+        DEBUG_EXIT();
+        return;
+    }
 
     state_.is_changed = true;
-    auto do_failsafe = false;
 
-    if (source_a && source_b) {
-        state_.is_network_data_loss = true;
-        state_.is_merge_mode = false;
-        state_.is_synchronized = false;
-        state_.is_forced_synchronized = false;
-        state_.priority = e131::priority::kLowest;
-
-        for (uint32_t i = 0; i < dmxnode::kMaxPorts; i++) {
-            if (output_port_[i].is_transmitting) {
-                do_failsafe = true;
-                output_port_[i].source_a.ip = 0;
-                memset(output_port_[i].source_a.cid, 0, e117::kCidLength);
-                output_port_[i].source_b.ip = 0;
-                memset(output_port_[i].source_b.cid, 0, e117::kCidLength);
-                dmxnode::Data::ClearLength(i);
-                output_port_[i].is_transmitting = false;
-                output_port_[i].is_merging = false;
-            }
+    dmxnode::Data::ClearLength(port_index);
+    output_port.is_transmitting = false;
+
+    for (const auto& port : output_port_) {
+        if (port.is_transmitting) {
+            DEBUG_EXIT();
+            return;
         }
-    } else {
-        for (uint32_t i = 0; i < dmxnode::kMaxPorts; i++) {
-            if (output_port_[i].is_transmitting) {
-                if ((source_a) && (output_port_[i].source_a.ip != 0)) {
-                    output_port_[i].source_a.ip = 0;
-                    memset(output_port_[i].source_a.cid, 0, e117::kCidLength);
-                    output_port_[i].is_merging = false;
-                }
+    }
 
-                if ((source_b) && (output_port_[i].source_b.ip != 0)) {
-                    output_port_[i].source_b.ip = 0;
-                    memset(output_port_[i].source_b.cid, 0, e117::kCidLength);
-                    output_port_[i].is_merging = false;
-                }
+    FailSafe();
 
-                if (!state_.is_merge_mode) {
-                    do_failsafe = true;
-                    dmxnode::Data::ClearLength(i);
-                    output_port_[i].is_transmitting = false;
-                }
-            }
+    DEBUG_EXIT();
+}
+
+void E131Bridge::SetNetworkDataLossCondition() {
+    DEBUG_ENTRY();
+
+    state_.is_changed = true;
+    state_.is_network_data_loss = true;
+    state_.is_merge_mode = false;
+    state_.is_synchronized = false;
+    state_.is_forced_synchronized = false;
+
+    auto do_failsafe = false;
+
+    for (uint32_t i = 0; i < dmxnode::kMaxPorts; i++) {
+        auto& output_port = output_port_[i];
+
+        if (output_port.is_transmitting) {
+            do_failsafe = true;
+            dmxnode::Data::ClearLength(i);
+            output_port.is_transmitting = false;
+        }
+
+        for (uint32_t source_index = 0; source_index < e131bridge::kMaxSources; source_index++) {
+            RemoveSource(i, source_index);
         }
+
+        output_port.winning_sources = 0;
+        output_port.winning_priority = 0;
+        output_port.is_merging = false;
     }
 
     if (do_failsafe) {
-        switch (state_.failsafe) {
-            case dmxnode::FailSafe::kHold:
-                break;
-            case dmxnode::FailSafe::kOff:
-                dmxnode_output_type_->Blackout(true);
-                break;
-            case dmxnode::FailSafe::kOn:
-                dmxnode_output_type_->FullOn();
-                break;
-            default:
-                DEBUG_PRINTF("state_.failsafe=%u", static_cast<unsigned>(state_.failsafe));
-                assert(false && "Invalid state_.failsafe");
-                break;
-        }
+        FailSafe();
     }
 
     state_.receiving_dmx &= static_cast<uint8_t>(~(1U << static_cast<uint8_t>(dmxnode::Direction::kOutput)));
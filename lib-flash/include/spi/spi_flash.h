@@ -32,6 +32,20 @@ namespace spi::flash
 {
 inline constexpr uint32_t PAGE_SIZE = 256;
 inline constexpr uint32_t SECTOR_SIZE = 4096;
+inline constexpr uint32_t CACHE_PAGES =
+#if defined(CONFIG_SPI_FLASH_CACHE_PAGES)
+    CONFIG_SPI_FLASH_CACHE_PAGES;
+#else
+    0; // Opt-in per product, a page costs 264 bytes of RAM
+#endif
+
+struct CacheStats
+{
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t read_ahead;
+    uint32_t bypass;
+};
 } // namespace spi::flash
 
 bool spi_flash_probe();
@@ -49,4 +63,7 @@ bool spi_flash_cmd_write_multi(uint32_t offset, uint32_t length, const uint8_t*
 bool spi_flash_cmd_erase(uint32_t offset, uint32_t length);
 bool spi_flash_cmd_write_status(uint8_t sr);
 
+const spi::flash::CacheStats& spi_flash_cache_get_stats();
+void spi_flash_cache_invalidate();
+
 #endif  // SPI_SPI_FLASH_H_
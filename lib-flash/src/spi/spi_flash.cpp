@@ -27,6 +27,7 @@
  */
 
 #include <cstdint>
+#include <cstring>
 #include <algorithm>
 #include <time.h>
 
@@ -86,6 +87,32 @@ static constexpr struct {
 
 #define IDCODE_LEN IDCODE_PART_LEN
 
+/*
+ * Page cache
+ *
+ * Small reads (configuration, scenes, web content) are served from a LRU
+ * cache of flash pages. A miss on the page following the previous access is
+ * treated as a sequential read and the next page is fetched as well.
+ * Reads larger than half of the cache bypass it, so they do not flush the
+ * working set. Program and erase invalidate the pages they touch.
+ */
+namespace spi::flash {
+static_assert(CACHE_PAGES == 0 || CACHE_PAGES >= 2, "The cache needs at least 2 pages");
+static constexpr uint32_t kPageInvalid = UINT32_MAX;
+static constexpr uint32_t kCacheBypassLength = (CACHE_PAGES / 2) * PAGE_SIZE;
+
+struct CachePage {
+    uint32_t page;
+    uint32_t age;
+    uint8_t data[PAGE_SIZE];
+};
+
+static CachePage s_cache[CACHE_PAGES != 0 ? CACHE_PAGES : 1];
+static uint32_t s_cache_age;
+static uint32_t s_last_page = kPageInvalid;
+static CacheStats s_cache_stats;
+} // namespace spi::flash
+
 static uint32_t GetTimer(uint32_t base) {
     if (0 == base) {
         return static_cast<uint32_t>(time(nullptr));
@@ -193,9 +220,30 @@ static bool SpiFlashWriteCommon(const uint8_t* pCommand, const uint32_t nCommand
     return true;
 }
 
+static void CacheInvalidate(uint32_t offset, uint32_t length) {
+    if constexpr (spi::flash::CACHE_PAGES != 0) {
+        if (length == 0) {
+            return;
+        }
+
+        const auto kFirst = offset / spi::flash::PAGE_SIZE;
+        const auto kLast = (offset + length - 1) / spi::flash::PAGE_SIZE;
+
+        for (auto& entry : spi::flash::s_cache) {
+            if ((entry.page >= kFirst) && (entry.page <= kLast)) {
+                entry.page = spi::flash::kPageInvalid;
+            }
+        }
+
+        spi::flash::s_last_page = spi::flash::kPageInvalid;
+    }
+}
+
 bool spi_flash_cmd_write_multi(uint32_t nOffset, uint32_t length, const uint8_t* pData) {
     SPI_FLASH_DEBUG_ENTRY();
 
+    CacheInvalidate(nOffset, length);
+
     if (!SpiFlashCmdWaitReady(SPI_FLASH_SECTOR_ERASE_TIMEOUT)) {
         SPI_FLASH_DEBUG_EXIT();
         return false;
@@ -240,7 +288,7 @@ void spi_flash_read_common(const uint8_t* pCommand, uint32_t nCommandLength, uin
     return SpiFlashCmdRead(pCommand, nCommandLength, pData, nDataLength);
 }
 
-bool spi_flash_cmd_read_fast(uint32_t nOffset, uint32_t length, uint8_t* pData) {
+static bool SpiFlashCmdReadFast(uint32_t nOffset, uint32_t length, uint8_t* pData) {
     SPI_FLASH_DEBUG_ENTRY();
 
     if (!SpiFlashCmdWaitReady(SPI_FLASH_PROG_TIMEOUT)) {
@@ -274,6 +322,100 @@ bool spi_flash_cmd_read_fast(uint32_t nOffset, uint32_t length, uint8_t* pData)
     return true;
 }
 
+static spi::flash::CachePage* CacheLookup(uint32_t page) {
+    for (auto& entry : spi::flash::s_cache) {
+        if (entry.page == page) {
+            entry.age = ++spi::flash::s_cache_age;
+            return &entry;
+        }
+    }
+
+    return nullptr;
+}
+
+static spi::flash::CachePage* CacheFill(uint32_t page) {
+    auto* victim = &spi::flash::s_cache[0];
+
+    for (auto& entry : spi::flash::s_cache) {
+        if (entry.page == spi::flash::kPageInvalid) {
+            victim = &entry;
+            break;
+        }
+        if (entry.age < victim->age) {
+            victim = &entry;
+        }
+    }
+
+    victim->page = spi::flash::kPageInvalid;
+
+    if (!SpiFlashCmdReadFast(page * spi::flash::PAGE_SIZE, spi::flash::PAGE_SIZE, victim->data)) {
+        return nullptr;
+    }
+
+    victim->page = page;
+    victim->age = ++spi::flash::s_cache_age;
+
+    return victim;
+}
+
+bool spi_flash_cmd_read_fast(uint32_t nOffset, uint32_t length, uint8_t* pData) {
+    using namespace spi::flash;
+
+    if ((CACHE_PAGES == 0) || (length > kCacheBypassLength)) {
+        s_cache_stats.bypass++;
+        return SpiFlashCmdReadFast(nOffset, length, pData);
+    }
+
+    while (length != 0) {
+        const auto kPage = nOffset / PAGE_SIZE;
+        const auto kIndex = nOffset % PAGE_SIZE;
+        const auto kLength = std::min(length, PAGE_SIZE - kIndex);
+
+        auto* entry = CacheLookup(kPage);
+
+        if (entry != nullptr) {
+            s_cache_stats.hits++;
+        } else {
+            s_cache_stats.misses++;
+
+            if ((entry = CacheFill(kPage)) == nullptr) {
+                return false;
+            }
+
+            const auto kNextOffset = (kPage + 1) * PAGE_SIZE;
+
+            if ((s_last_page != kPageInvalid) && (kPage == (s_last_page + 1)) && (kNextOffset < s_flash.size) && (CacheLookup(kPage + 1) == nullptr)) {
+                if (CacheFill(kPage + 1) != nullptr) {
+                    s_cache_stats.read_ahead++;
+                }
+                // Keep the requested page the most recent one
+                entry->age = ++s_cache_age;
+            }
+        }
+
+        memcpy(pData, &entry->data[kIndex], kLength);
+
+        s_last_page = kPage;
+        nOffset += kLength;
+        length -= kLength;
+        pData += kLength;
+    }
+
+    return true;
+}
+
+const spi::flash::CacheStats& spi_flash_cache_get_stats() {
+    return spi::flash::s_cache_stats;
+}
+
+void spi_flash_cache_invalidate() {
+    for (auto& entry : spi::flash::s_cache) {
+        entry.page = spi::flash::kPageInvalid;
+    }
+
+    spi::flash::s_last_page = spi::flash::kPageInvalid;
+}
+
 bool spi_flash_cmd_erase(uint32_t nOffset, uint32_t length) {
     SPI_FLASH_DEBUG_ENTRY();
 
@@ -288,6 +430,8 @@ bool spi_flash_cmd_erase(uint32_t nOffset, uint32_t length) {
         return false;
     }
 
+    CacheInvalidate(nOffset, length);
+
     static_assert(spi::flash::SECTOR_SIZE == 4096);
     uint8_t cmd[4];
     cmd[0] = CMD_ERASE_4K;
@@ -327,6 +471,7 @@ bool spi_flash_cmd_write_status(uint8_t sr) {
 
 bool spi_flash_probe() {
     SpiInit();
+    spi_flash_cache_invalidate();
 
     uint8_t idcode[IDCODE_LEN];
     SpiFlashCmd(CMD_READ_ID, idcode, sizeof(idcode));
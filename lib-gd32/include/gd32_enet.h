@@ -26,6 +26,9 @@
 #ifndef GD32_ENET_H_
 #define GD32_ENET_H_
 
+#include <cstdint>
+#include <cstring>
+
 #include "gd32.h" // IWYU pragma: keep
 
 namespace gd32::enet {
@@ -274,5 +277,36 @@ inline void FilterSetHash(uint32_t hash) {
     }
 }
 #endif
+
+/*
+ * Perfect (exact) destination address filter, MAC address 1..3
+ */
+#if defined(GD32H7XX)
+inline void FilterSetPerfect(enet_macaddress_enum slot, const uint8_t* mac) {
+    uint8_t address[6];
+    memcpy(address, mac, sizeof(address));
+    enet_address_filter_disable(ENETx, slot);
+    enet_mac_address_set(ENETx, slot, address);
+    enet_address_filter_config(ENETx, slot, 0, ENET_ADDRESS_FILTER_DA);
+    enet_address_filter_enable(ENETx, slot);
+}
+
+inline void FilterResetPerfect(enet_macaddress_enum slot) {
+    enet_address_filter_disable(ENETx, slot);
+}
+#else
+inline void FilterSetPerfect(enet_macaddress_enum slot, const uint8_t* mac) {
+    uint8_t address[6];
+    memcpy(address, mac, sizeof(address));
+    enet_address_filter_disable(slot);
+    enet_mac_address_set(slot, address);
+    enet_address_filter_config(slot, 0, ENET_ADDRESS_FILTER_DA);
+    enet_address_filter_enable(slot);
+}
+
+inline void FilterResetPerfect(enet_macaddress_enum slot) {
+    enet_address_filter_disable(slot);
+}
+#endif
 } // namespace gd32::enet
 #endif // GD32_ENET_H_
@@ -31,6 +31,13 @@
 
 namespace tftp {
 enum class Mode { kBinary, kAscii };
+
+struct Statistics {
+    uint32_t bytes;      ///< Payload bytes transferred
+    uint32_t blocks;     ///< Data blocks transferred
+    uint32_t duplicates; ///< Duplicate or out of order data blocks received
+    uint32_t millis;     ///< Duration of the (last) transfer
+};
 } // namespace tftp
 
 class TFTPDaemon {
@@ -45,12 +52,21 @@ class TFTPDaemon {
     virtual bool FileClose() = 0;
     virtual size_t FileRead(void* buffer, size_t count, unsigned block_number) = 0;
     virtual size_t FileWrite(const void* buffer, size_t count, unsigned block_number) = 0;
+    // RFC 2349 tsize for read requests, 0 is unknown
+    virtual size_t FileSize() { return 0; }
 
     virtual void Exit() = 0;
 
+    // RFC 2349 tsize as announced by the client in a write request, 0 is unknown
+    uint32_t GetTransferSize() const { return transfer_size_; }
+
+    const tftp::Statistics& GetStatistics() const { return statistics_; }
+
    private:
     void Init();
     void HandleRequest();
+    void ParseOptions(const char* options, const char* end, bool is_read_request);
+    void SendOptionAck();
     void HandleRecvAck();
     void HandleRecvData();
     void SendError(uint16_t error_code, const char* error_message);
@@ -66,9 +82,17 @@ class TFTPDaemon {
     uint32_t length_{0};
     uint32_t data_length_{0};
     uint32_t packet_length_{0};
+    uint32_t transfer_size_{0};
+    uint32_t start_millis_{0};
     uint16_t from_port_{0};
     uint16_t block_number_{0};
+    uint16_t block_size_{512};
+    uint16_t window_size_{1};
+    uint16_t window_count_{0};
+    uint16_t gap_count_{0};
+    uint8_t options_{0};
     bool is_last_block_{false};
+    tftp::Statistics statistics_{};
 
     static TFTPDaemon* Get() { return s_this; }
 
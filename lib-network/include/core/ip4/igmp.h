@@ -29,10 +29,15 @@
 #include <cstdint>
 
 namespace emac::multicast {
+/// MAC address 1..3, exact match, used for the first joined groups
+inline constexpr uint32_t kPerfectSlots = 3;
+
 void EnableHashFilter();
 void DisableHashFilter();
 void SetHash(const uint8_t*);
 void ResetHash();
+void SetPerfect(uint32_t slot, const uint8_t*);
+void ResetPerfect();
 } // namespace emac::multicast
 
 #endif // CORE_IP4_IGMP_H_
@@ -35,7 +35,11 @@ struct Ports {
     static constexpr uint16_t kPortTftp = 69;
     static constexpr uint16_t kPortHttp = 80;
     static constexpr uint16_t kPortNtp = 123;
+    static constexpr uint16_t kPortDdp = 4048;
     static constexpr uint16_t kPortMdns = 5353;
+    static constexpr uint16_t kPortSacn = 5568;
+    static constexpr uint16_t kPortLlrp = 5569;
+    static constexpr uint16_t kPortArtNet = 6454;
 	static constexpr uint16_t kPortHttpAlt = 8080;
 };
 } // namespace network::iana
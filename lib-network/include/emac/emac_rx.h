@@ -0,0 +1,121 @@
+/**
+ * @file emac_rx.h
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef EMAC_EMAC_RX_H_
+#define EMAC_EMAC_RX_H_
+
+#include <cstdint>
+
+#include "core/protocol/ethernet.h"
+
+/*
+ * Budgeted receive.
+ *
+ * Each frame in the Rx ring is classified on its Ethernet/IP/UDP header.
+ * Every class has a packet budget per network::Run.
+ *
+ * A control or other frame without budget only waits when a DMX frame is
+ * received behind it. Otherwise it stays in the ring for the next iteration.
+ * With CONFIG_EMAC_RX_QUEUE_SIZE, a waiting frame is copied into a small queue
+ * and its descriptor is released, so the DMX frames behind it are reached.
+ * Without the queue, or when the queue is full, it is processed beyond the
+ * budget. Nothing is dropped here.
+ *
+ * A DMX frame without budget stays in the ring, so the super loop gets back
+ * to the DMX/pixel output. When the ring is about to overflow, any frame is
+ * processed beyond the budget.
+ */
+namespace emac::rx {
+enum class Class : uint8_t {
+    kDmx,     ///< Art-Net ArtDmx/ArtNzs/ArtSync, sACN, DDP
+    kControl, ///< Art-Net other, LLRP, ARP, IGMP, PTP
+    kOther,   ///< TCP, mDNS, TFTP, DHCP, ICMP, ...
+    kUndefined
+};
+
+inline constexpr uint32_t kClasses = static_cast<uint32_t>(Class::kUndefined);
+
+inline constexpr uint32_t kBudgetDmx =
+#if defined(CONFIG_EMAC_RX_BUDGET_DMX)
+    CONFIG_EMAC_RX_BUDGET_DMX;
+#else
+    16;
+#endif
+
+inline constexpr uint32_t kBudgetControl =
+#if defined(CONFIG_EMAC_RX_BUDGET_CONTROL)
+    CONFIG_EMAC_RX_BUDGET_CONTROL;
+#else
+    4;
+#endif
+
+inline constexpr uint32_t kBudgetOther =
+#if defined(CONFIG_EMAC_RX_BUDGET_OTHER)
+    CONFIG_EMAC_RX_BUDGET_OTHER;
+#else
+    2;
+#endif
+
+static_assert((kBudgetDmx != 0) && (kBudgetControl != 0) && (kBudgetOther != 0));
+
+/*
+ * Each queue entry takes about 1.5 kB RAM, the queue is enabled per product.
+ */
+inline constexpr uint32_t kQueueSize =
+#if defined(CONFIG_EMAC_RX_QUEUE_SIZE)
+    CONFIG_EMAC_RX_QUEUE_SIZE;
+#else
+    0;
+#endif
+
+static_assert((kQueueSize & (kQueueSize - 1)) == 0, "kQueueSize must be a power of 2");
+
+inline constexpr uint32_t kQueueFrameSize = sizeof(network::ethernet::Header) + network::ethernet::kMtuSize + 4; ///< Including the FCS
+
+struct Counters {
+    uint32_t received;
+    uint32_t deferred;       ///< No budget: DMX left in the Rx ring, others queued
+    uint32_t forced;         ///< Processed beyond the budget, to reach a waiting DMX frame or to avoid a ring overflow
+    uint32_t latency_max_us; ///< Longest wait of a deferred frame
+};
+
+inline const char* GetClassName(Class c) {
+    constexpr const char* kNames[kClasses] = {"dmx", "control", "other"};
+    return (c < Class::kUndefined) ? kNames[static_cast<uint32_t>(c)] : "undefined";
+}
+
+Class Classify(const uint8_t* frame);
+void Run();
+const Counters& GetCounters(Class c);
+
+/*
+ * A queued frame is handed to EthernetInput from the queue, not from the Rx
+ * ring. emac::eth::FreePkt then has no descriptor to release.
+ */
+bool IsQueuedFrame();
+void FreeQueuedFrame();
+} // namespace emac::rx
+
+#endif // EMAC_EMAC_RX_H_
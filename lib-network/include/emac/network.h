@@ -44,6 +44,8 @@
 #include "emac/emac_link_check.h"
 #endif
 #include "emac/emac_phy.h"
+#include "emac/emac_rx.h"
+#include "firmware/debug/debug_profile.h"
 
 uint32_t emac::eth::Recv(uint8_t**);
 
@@ -60,15 +62,8 @@ void Run();
 #endif
 
 inline void Run() {
-    uint8_t* ethernet_buffer;
-    auto length = emac::eth::Recv(&ethernet_buffer);
-
-    if (__builtin_expect((length > 0), 0)) {
-        do {
-            network::iface::EthernetInput(ethernet_buffer, length);
-            length = emac::eth::Recv(&ethernet_buffer);
-        } while (length > 0);
-    }
+    DEBUG_PROFILE_SCOPE(kNetworkRun);
+    emac::rx::Run();
 #if defined(ENABLE_HTTPD)
     network::tcp::Run();
 #endif
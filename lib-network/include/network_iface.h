@@ -97,6 +97,7 @@ inline char AddressingMode() {
 struct Counters {
     struct Receive {
         uint32_t ok = 0, err = 0, drp = 0, ovr = 0;
+        uint32_t mc_drp = 0; ///< Multicast frames for a group we did not join
     } rx;
     struct Transmit {
         uint32_t ok = 0, err = 0, drp = 0, ovr = 0;
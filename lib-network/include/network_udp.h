@@ -30,8 +30,14 @@
 
 namespace network::udp {
 typedef void (*UdpCallbackFunctionPtr)(const uint8_t*, uint32_t, uint32_t, uint16_t);
+typedef bool (*UdpZeroCopyFunctionPtr)(const uint8_t*, uint32_t);
 
-int32_t Begin(uint16_t, UdpCallbackFunctionPtr callback);
+/**
+ * @param is_zero_copy Called per packet. When it returns true, the callback gets the payload in
+ *        the receive buffer of the EMAC: read-only, 2-byte aligned and only valid during the callback.
+ *        All other packets are copied first, so their handlers may reply in place.
+ */
+int32_t Begin(uint16_t, UdpCallbackFunctionPtr callback, UdpZeroCopyFunctionPtr is_zero_copy = nullptr);
 int32_t End(uint16_t);
 uint32_t Recv(const int32_t, const uint8_t**, uint32_t*, uint16_t*);
 void Send(int32_t, const uint8_t*, uint32_t, uint32_t, uint16_t);
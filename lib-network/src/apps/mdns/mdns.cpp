@@ -36,6 +36,7 @@
 #include "core/protocol/ip4.h"
 #include "core/protocol/dns.h"
 #include "core/protocol/iana.h"
+#include "timing.h"
 #include "firmware/debug/debug_debug.h"
 
 #if defined(DEBUG_NETWORK_APPS_MDNS)
@@ -57,6 +58,15 @@ static constexpr auto kServiceRecordsMax = 8;
 static constexpr uint32_t kServiceRecordsMax = MDNS_SERVICE_RECORDS_MAX;
 #endif
 
+#if !defined(CONFIG_MDNS_CACHE_SIZE)
+static constexpr uint32_t kCacheSize = 2048;
+#else
+static constexpr uint32_t kCacheSize = CONFIG_MDNS_CACHE_SIZE;
+#endif
+
+static constexpr uint32_t kRateLimitMillis = 1000; ///< RFC 6762, 6. Responding
+static constexpr uint32_t kServiceAnswers = 4;      ///< Type PTR, name PTR, SRV and TXT
+
 static constexpr size_t kDomainMaxlen = 256;
 static constexpr size_t kLabelMaxlen = 63;
 static constexpr size_t kTxtMaxlen = 256;
@@ -89,6 +99,8 @@ struct ServiceReply {
     static constexpr uint32_t kTxt = 0x80;
 };
 
+static_assert(ServiceReply::kNamePtr == (ServiceReply::kTypePtr << 1) && ServiceReply::kSrv == (ServiceReply::kTypePtr << 2) && ServiceReply::kTxt == (ServiceReply::kTypePtr << 3));
+
 enum class OpCodes { kQuery = 0, kIQuery = 1, kStatus = 2, kNotify = 4, kUpdate = 5 };
 
 enum class Protocols { kUdp, kTcp };
@@ -200,6 +212,27 @@ static uint16_t s_n_remote_port;
 static bool s_is_unicast;
 static bool s_is_legacy_query;
 
+/*
+ * The answer records are serialised once, when a service, the host name or the IP changes.
+ * A reply copies them, compresses the names and sets the TTL.
+ */
+struct CachedRecord {
+    uint16_t offset;
+    uint16_t length; ///< Serialised length, also when the record is not cached
+    uint32_t millis_multicast;
+    bool is_cached; ///< false when the record did not fit, it is then serialised into the reply
+};
+
+static uint8_t s_cache[kCacheSize];
+static uint32_t s_cache_used;
+static uint32_t s_cache_ip;
+static bool s_is_cache_valid;
+static CachedRecord s_cached_service[kServiceRecordsMax][kServiceAnswers];
+static CachedRecord s_cached_a;
+#if defined(CONFIG_MDNS_DOMAIN_REVERSE)
+static CachedRecord s_cached_reverse;
+#endif
+
 static void CreateServiceDomain(mdns::Domain& domain, ServiceRecord const& service_record, bool include_name) {
     MDNS_DEBUG_ENTRY();
 
@@ -274,109 +307,26 @@ static void CreateReverseDomain(Domain& domain) {
 #endif
 
 /*
- * https://opensource.apple.com/source/mDNSResponder/mDNSResponder-26.2/mDNSCore/mDNS.c.auto.html
- * mDNSlocal const mDNSu8 *FindCompressionPointer(const mDNSu8 *const base, const mDNSu8 *const end, const mDNSu8 *const domname)
+ * The names are not compressed, so a serialised record can be copied into any reply.
+ * PutRecord compresses them against the reply.
  */
-static uint8_t* FindCompressionPointer(const uint8_t* const kBase, const uint8_t* const kEnd, const uint8_t* const kDomname) {
-    const auto* result = kEnd - *kDomname - 1;
-
-    while (result >= kBase) {
-        if (result[0] == kDomname[0] && result[1] == kDomname[1]) {
-            const auto* name = kDomname;
-            const auto* targ = result;
-
-            while (targ + *name < kEnd) {
-                // First see if this label matches
-                int i;
-
-                for (i = 0; i <= *name; i++) {
-                    if (targ[i] != name[i]) {
-                        break;
-                    }
-                }
-
-                if (i <= *name) {
-                    break; // If label did not match, bail out
-                }
-
-                targ += 1 + *name; // Else, did match, so advance target pointer
-                name += 1 + *name; // and proceed to check next label
-
-                if (*name == 0 && *targ == 0) { // If no more labels, we found a match!
-                    return const_cast<uint8_t*>(result);
-                }
-
-                if (*name == 0) { // If no more labels to match, we failed, so bail out
-                    break;
-                }
-
-                // The label matched, so now follow the pointer (if appropriate) and then see if the next label matches
-                if (targ[0] < 0x40) {
-                    continue; // If length value, continue to check next label
-                }
-
-                if (targ[0] < 0xC0) {
-                    break; // If 40-BF, not valid
-                }
-
-                if (targ + 1 >= kEnd) {
-                    break; // Second byte not present!
-                }
-
-                const uint8_t* pointertarget = kBase + ((static_cast<uint16_t>(targ[0] & 0x3F)) << 8) + targ[1];
-
-                if (targ < pointertarget) {
-                    break; // Pointertarget must point *backwards* in the packet
-                }
-
-                if (pointertarget[0] >= 0x40) {
-                    break; // Pointertarget must point to a valid length byte
-                }
-
-                targ = pointertarget;
-            }
-        }
-
-        result--; // We failed to match at this search position, so back up the tentative result pointer and try again
-    }
-
-    return nullptr;
+static uint8_t* PutDomainName(uint8_t* ptr, Domain const& domain) {
+    memcpy(ptr, domain.a_name, domain.length);
+    return ptr + domain.length;
 }
 
-/*
- * https://opensource.apple.com/source/mDNSResponder/mDNSResponder-26.2/mDNSCore/mDNS.c.auto.html
- * mDNSlocal mDNSu8 *putDomainNameAsLabels(const DNSMessage *const msg, mDNSu8 *ptr, const mDNSu8 *const limit, const domainname *const name)
- */
-static uint8_t* PutDomainNameAsLabels(uint8_t* ptr, Domain const& domain) {
-    const uint8_t* const kBase = s_records_data;
-    const auto* np = domain.a_name;
-    uint8_t* pointer = nullptr;
-    const auto* const kSearchlimit = ptr;
-
-    while (*np) {
-        pointer = FindCompressionPointer(kBase, kSearchlimit, np);
+static uint16_t GetNameLength(const uint8_t* name) {
+    uint32_t length = 0;
 
-        if (pointer != nullptr) {
-            auto offset = static_cast<uint16_t>(pointer - kBase);
-            *ptr++ = static_cast<uint8_t>(0xC0 | (offset >> 8));
-            *ptr++ = static_cast<uint8_t>(offset);
-            return ptr;
-        }
-
-        auto len = *np++;
-        *ptr++ = len;
-
-        for (uint32_t i = 0; i < len; i++) {
-            *ptr++ = *np++;
-        }
+    while ((name[length] != 0) && (length < kDomainMaxlen)) {
+        length += 1U + name[length];
     }
 
-    *ptr++ = 0;
-    return ptr;
+    return static_cast<uint16_t>(length + 1U);
 }
 
 static uint8_t* AddQuestion(uint8_t* destination, const mdns::Domain& domain, network::dns::RRType type, bool do_flush) {
-    auto* dst = PutDomainNameAsLabels(destination, domain);
+    auto* dst = PutDomainName(destination, domain);
 
     *reinterpret_cast<volatile uint16_t*>(dst) = __builtin_bswap16(static_cast<uint16_t>(type));
     dst += 2;
@@ -405,7 +355,7 @@ static uint32_t AddAnswerSrv(mdns::ServiceRecord const& service_record, uint8_t*
     auto* begin = dst;
 
     CreateHostDomain(domain);
-    dst = PutDomainNameAsLabels(dst, domain);
+    dst = PutDomainName(dst, domain);
 
     *reinterpret_cast<uint16_t*>(lengt_pointer) = __builtin_bswap16(static_cast<uint16_t>(6U + dst - begin));
 
@@ -458,7 +408,7 @@ static uint32_t AddAnswerPtr(mdns::ServiceRecord const& service_record, uint8_t*
     auto* begin = dst;
 
     CreateServiceDomain(domain, service_record, true);
-    dst = PutDomainNameAsLabels(dst, domain);
+    dst = PutDomainName(dst, domain);
 
     *reinterpret_cast<uint16_t*>(lengt_pointer) = __builtin_bswap16(static_cast<uint16_t>(dst - begin));
 
@@ -480,7 +430,7 @@ static uint32_t AddAnswerDnsdPtr(mdns::ServiceRecord const& service_record, uint
     Domain domain;
 
     CreateServiceDomain(domain, service_record, false);
-    dst = PutDomainNameAsLabels(dst, domain);
+    dst = PutDomainName(dst, domain);
 
     *reinterpret_cast<uint16_t*>(lengt_pointer) = __builtin_bswap16(static_cast<uint16_t>(dst - begin));
 
@@ -523,7 +473,7 @@ static uint32_t AddAnswerHostv4Ptr(uint8_t* destination, uint32_t ttl) {
     auto* begin = dst;
 
     CreateHostDomain(domain);
-    dst = PutDomainNameAsLabels(dst, domain);
+    dst = PutDomainName(dst, domain);
 
     *reinterpret_cast<uint16_t*>(lengt_pointer) = __builtin_bswap16(static_cast<uint16_t>(dst - begin));
 
@@ -532,6 +482,262 @@ static uint32_t AddAnswerHostv4Ptr(uint8_t* destination, uint32_t ttl) {
 }
 #endif
 
+using AddAnswerFunction = uint32_t (*)(mdns::ServiceRecord const&, uint8_t*, uint32_t);
+
+static constexpr AddAnswerFunction kAddAnswer[kServiceAnswers] = {AddAnswerDnsdPtr, AddAnswerPtr, AddAnswerSrv, AddAnswerTxt};
+
+/*
+ * The record is serialised in s_records_data, which is not in use between replies.
+ */
+static void CacheAdd(CachedRecord& cached, uint32_t length) {
+    cached.length = static_cast<uint16_t>(length);
+    cached.is_cached = false;
+
+    if (length > (kCacheSize - s_cache_used)) {
+        MDNS_DEBUG_PRINTF("Cache full: %u", static_cast<unsigned>(length));
+        return;
+    }
+
+    memcpy(&s_cache[s_cache_used], s_records_data, length);
+
+    cached.offset = static_cast<uint16_t>(s_cache_used);
+
+    cached.is_cached = true;
+    s_cache_used += length;
+}
+
+static void CacheBuild() {
+    if (s_is_cache_valid && (s_cache_ip == network::GetPrimaryIp())) {
+        return;
+    }
+
+    MDNS_DEBUG_ENTRY();
+
+    s_cache_used = 0;
+
+    for (uint32_t index = 0; index < kServiceRecordsMax; index++) {
+        const auto& record = s_service_records[index];
+
+        for (uint32_t answer = 0; answer < kServiceAnswers; answer++) {
+            if (record.services < Services::kLastNotUsed) {
+                CacheAdd(s_cached_service[index][answer], kAddAnswer[answer](record, s_records_data, 0));
+            } else {
+                s_cached_service[index][answer].length = 0;
+                s_cached_service[index][answer].is_cached = false;
+            }
+        }
+    }
+
+    CacheAdd(s_cached_a, AddAnswerA(s_records_data, 0));
+#if defined(CONFIG_MDNS_DOMAIN_REVERSE)
+    CacheAdd(s_cached_reverse, AddAnswerHostv4Ptr(s_records_data, 0));
+#endif
+
+    s_cache_ip = network::GetPrimaryIp();
+    s_is_cache_valid = true;
+
+    MDNS_DEBUG_PRINTF("s_cache_used=%u", static_cast<unsigned>(s_cache_used));
+    MDNS_DEBUG_EXIT();
+}
+
+/*
+ * https://opensource.apple.com/source/mDNSResponder/mDNSResponder-26.2/mDNSCore/mDNS.c.auto.html
+ * mDNSlocal const mDNSu8 *FindCompressionPointer(const mDNSu8 *const base, const mDNSu8 *const end, const mDNSu8 *const domname)
+ */
+static uint8_t* FindCompressionPointer(const uint8_t* const kBase, const uint8_t* const kEnd, const uint8_t* const kDomname) {
+    const auto* result = kEnd - *kDomname - 1;
+
+    while (result >= kBase) {
+        if (result[0] == kDomname[0] && result[1] == kDomname[1]) {
+            const auto* name = kDomname;
+            const auto* targ = result;
+
+            while (targ + *name < kEnd) {
+                // First see if this label matches
+                int i;
+
+                for (i = 0; i <= *name; i++) {
+                    if (targ[i] != name[i]) {
+                        break;
+                    }
+                }
+
+                if (i <= *name) {
+                    break; // If label did not match, bail out
+                }
+
+                targ += 1 + *name; // Else, did match, so advance target pointer
+                name += 1 + *name; // and proceed to check next label
+
+                if (*name == 0 && *targ == 0) { // If no more labels, we found a match!
+                    return const_cast<uint8_t*>(result);
+                }
+
+                if (*name == 0) { // If no more labels to match, we failed, so bail out
+                    break;
+                }
+
+                // The label matched, so now follow the pointer (if appropriate) and then see if the next label matches
+                if (targ[0] < 0x40) {
+                    continue; // If length value, continue to check next label
+                }
+
+                if (targ[0] < 0xC0) {
+                    break; // If 40-BF, not valid
+                }
+
+                if (targ + 1 >= kEnd) {
+                    break; // Second byte not present!
+                }
+
+                const uint8_t* pointertarget = kBase + ((static_cast<uint16_t>(targ[0] & 0x3F)) << 8) + targ[1];
+
+                if (targ < pointertarget) {
+                    break; // Pointertarget must point *backwards* in the packet
+                }
+
+                if (pointertarget[0] >= 0x40) {
+                    break; // Pointertarget must point to a valid length byte
+                }
+
+                targ = pointertarget;
+            }
+        }
+
+        result--; // We failed to match at this search position, so back up the tentative result pointer and try again
+    }
+
+    return nullptr;
+}
+
+/*
+ * https://opensource.apple.com/source/mDNSResponder/mDNSResponder-26.2/mDNSCore/mDNS.c.auto.html
+ * mDNSlocal mDNSu8 *putDomainNameAsLabels(const DNSMessage *const msg, mDNSu8 *ptr, const mDNSu8 *const limit, const domainname *const name)
+ *
+ * The name may be in the message buffer after ptr, the labels are copied forward.
+ */
+static uint8_t* PutDomainNameAsLabels(uint8_t* ptr, const uint8_t* name) {
+    const uint8_t* const kBase = s_records_data;
+    const auto* np = name;
+    uint8_t* pointer = nullptr;
+    const auto* const kSearchlimit = ptr;
+
+    while (*np) {
+        pointer = FindCompressionPointer(kBase, kSearchlimit, np);
+
+        if (pointer != nullptr) {
+            auto offset = static_cast<uint16_t>(pointer - kBase);
+            *ptr++ = static_cast<uint8_t>(0xC0 | (offset >> 8));
+            *ptr++ = static_cast<uint8_t>(offset);
+            return ptr;
+        }
+
+        auto len = *np++;
+        *ptr++ = len;
+
+        for (uint32_t i = 0; i < len; i++) {
+            *ptr++ = *np++;
+        }
+    }
+
+    *ptr++ = 0;
+    return ptr;
+}
+
+/*
+ * Copies a serialised record into the reply at dst, with the owner name and the PTR/SRV target compressed.
+ * The source may be in the message buffer after dst, nothing is written beyond what has been read.
+ */
+static uint8_t* PutRecord(uint8_t* dst, const uint8_t* src, uint32_t ttl) {
+    const auto kNameLength = GetNameLength(src);
+    dst = PutDomainNameAsLabels(dst, src);
+    src += kNameLength;
+
+    uint16_t type;
+    memcpy(&type, src, sizeof(type));
+    memmove(dst, src, 4); // Type and class
+    dst += 4;
+    src += 4;
+
+    const auto kTtl = __builtin_bswap32(ttl);
+    memcpy(dst, &kTtl, sizeof(kTtl));
+    dst += 4;
+    src += 4;
+
+    uint16_t data_length;
+    memcpy(&data_length, src, sizeof(data_length));
+    data_length = __builtin_bswap16(data_length);
+    auto* length_pointer = dst;
+    dst += 2;
+    src += 2;
+    auto* begin = dst;
+
+    switch (static_cast<network::dns::RRType>(__builtin_bswap16(type))) {
+        case network::dns::RRType::kPtr:
+            dst = PutDomainNameAsLabels(dst, src);
+            break;
+        case network::dns::RRType::kSrv:
+            memmove(dst, src, 6); // Priority, weight and port
+            dst = PutDomainNameAsLabels(dst + 6, src + 6);
+            break;
+        default:
+            memmove(dst, src, data_length);
+            dst += data_length;
+            break;
+    }
+
+    const auto kDataLength = __builtin_bswap16(static_cast<uint16_t>(dst - begin));
+    memcpy(length_pointer, &kDataLength, sizeof(kDataLength));
+
+    return dst;
+}
+
+/*
+ * A record that is not cached is serialised at the end of the message buffer first.
+ * IsFitting has checked that it does not start before dst.
+ */
+static uint8_t* GetSerialiseBuffer(CachedRecord const& cached) {
+    return &s_records_data[sizeof(s_records_data) - cached.length];
+}
+
+/*
+ * Checked with the uncompressed length, the compressed record is never longer.
+ */
+static bool IsFitting(const uint8_t* dst, CachedRecord const& cached) {
+    return (dst + cached.length) <= &s_records_data[sizeof(s_records_data)];
+}
+
+static uint8_t* PutAnswerA(uint8_t* dst, uint32_t ttl) {
+    if (!s_cached_a.is_cached) {
+        auto* src = GetSerialiseBuffer(s_cached_a);
+        AddAnswerA(src, ttl);
+        return PutRecord(dst, src, ttl);
+    }
+    return PutRecord(dst, &s_cache[s_cached_a.offset], ttl);
+}
+
+static uint8_t* PutAnswerService(uint8_t* dst, uint32_t record_index, uint32_t answer, uint32_t ttl) {
+    const auto& cached = s_cached_service[record_index][answer];
+
+    if (!cached.is_cached) {
+        auto* src = GetSerialiseBuffer(cached);
+        kAddAnswer[answer](s_service_records[record_index], src, ttl);
+        return PutRecord(dst, src, ttl);
+    }
+    return PutRecord(dst, &s_cache[cached.offset], ttl);
+}
+
+#if defined(CONFIG_MDNS_DOMAIN_REVERSE)
+static uint8_t* PutAnswerHostv4Ptr(uint8_t* dst, uint32_t ttl) {
+    if (!s_cached_reverse.is_cached) {
+        auto* src = GetSerialiseBuffer(s_cached_reverse);
+        AddAnswerHostv4Ptr(src, ttl);
+        return PutRecord(dst, src, ttl);
+    }
+    return PutRecord(dst, &s_cache[s_cached_reverse.offset], ttl);
+}
+#endif
+
 /*
  * https://opensource.apple.com/source/mDNSResponder/mDNSResponder-26.2/mDNSCore/mDNS.c.auto.html
  * mDNSlocal const mDNSu8 *getDomainName(const DNSMessage *const msg, const mDNSu8 *ptr, const mDNSu8 *const end, domainname *const name)
@@ -646,11 +852,29 @@ static void Send(uint32_t length) {
     network::udp::Send(s_handle, s_records_data, length, s_n_remote_ip, s_n_remote_port);
 }
 
+/*
+ * RFC 6762, 18.5. TC bit: it is zero in multicast responses, a legacy unicast querier can retry over TCP.
+ */
+static uint8_t GetResponseFlag1(bool is_truncated) {
+    auto flag1 = network::dns::Flag1::kResponse | network::dns::Flag1::kAuthorative;
+
+    if (is_truncated && s_is_unicast) {
+        flag1 = static_cast<uint8_t>(flag1 | static_cast<uint8_t>(network::dns::Flag1::kTrunc));
+    }
+
+    return flag1;
+}
+
 static void SendAnswerLocalIpAddress(uint16_t trans_action_id, uint32_t ttl) {
     MDNS_DEBUG_ENTRY();
 
+    CacheBuild();
+
+    uint32_t questions = 0;
     uint32_t answers = 0;
     uint8_t* dst = reinterpret_cast<uint8_t*>(&s_records_data) + sizeof(struct network::dns::Header);
+    const auto kMillis = timing::Millis();
+    auto is_truncated = false;
 
 #if defined(CONFIG_MDNS_DOMAIN_REVERSE)
     if ((HostReply::kPtr & s_host_replies) == HostReply::kPtr) {
@@ -658,31 +882,42 @@ static void SendAnswerLocalIpAddress(uint16_t trans_action_id, uint32_t ttl) {
             Domain domain;
             CreateReverseDomain(domain);
             dst = AddQuestion(dst, domain, network::dns::RRType::kPtr, false);
+            questions++;
         }
     }
 #endif
 
     if ((HostReply::kA & s_host_replies) == HostReply::kA) {
-        answers++;
-        dst += AddAnswerA(dst, ttl);
+        if (IsFitting(dst, s_cached_a)) {
+            answers++;
+            dst = PutAnswerA(dst, ttl);
+            if (!s_is_unicast) {
+                s_cached_a.millis_multicast = kMillis;
+            }
+        } else {
+            is_truncated = true;
+        }
     }
 #if defined(CONFIG_MDNS_DOMAIN_REVERSE)
     if ((HostReply::kPtr & s_host_replies) == HostReply::kPtr) {
-        answers++;
-        dst += AddAnswerHostv4Ptr(dst, ttl);
+        if (IsFitting(dst, s_cached_reverse)) {
+            answers++;
+            dst = PutAnswerHostv4Ptr(dst, ttl);
+            if (!s_is_unicast) {
+                s_cached_reverse.millis_multicast = kMillis;
+            }
+        } else {
+            is_truncated = true;
+        }
     }
 #endif
 
     auto* header = reinterpret_cast<network::dns::Header*>(&s_records_data);
 
     header->xid = trans_action_id;
-    header->flag1 = network::dns::Flag1::kResponse | network::dns::Flag1::kAuthorative;
+    header->flag1 = GetResponseFlag1(is_truncated);
     header->flag2 = 0;
-#if defined(CONFIG_MDNS_DOMAIN_REVERSE)
-    header->query_count = __builtin_bswap16(static_cast<uint16_t>(s_is_legacy_query));
-#else
-    header->query_count = 0;
-#endif
+    header->query_count = __builtin_bswap16(static_cast<uint16_t>(questions));
     header->answer_count = __builtin_bswap16(static_cast<uint16_t>(answers));
     header->authority_count = 0;
     header->additional_count = 0;
@@ -693,43 +928,52 @@ static void SendAnswerLocalIpAddress(uint16_t trans_action_id, uint32_t ttl) {
     MDNS_DEBUG_EXIT();
 }
 
-static void SendMessage(mdns::ServiceRecord const& record, uint16_t transaction_id, uint32_t ttl) {
+static void SendMessage(uint32_t record_index, uint16_t transaction_id, uint32_t ttl) {
     MDNS_DEBUG_ENTRY();
 
+    CacheBuild();
+
     uint32_t answers = 0;
     auto* dst = reinterpret_cast<uint8_t*>(&s_records_data) + sizeof(struct network::dns::Header);
+    const auto kMillis = timing::Millis();
+    auto is_truncated = false;
 
-    if ((s_service_replies & ServiceReply::kTypePtr) == ServiceReply::kTypePtr) {
-        answers++;
-        dst += AddAnswerDnsdPtr(record, dst, ttl);
-    }
+    for (uint32_t answer = 0; answer < kServiceAnswers; answer++) {
+        if ((s_service_replies & (ServiceReply::kTypePtr << answer)) != 0) {
+            auto& cached = s_cached_service[record_index][answer];
 
-    if ((s_service_replies & ServiceReply::kNamePtr) == ServiceReply::kNamePtr) {
-        answers++;
-        dst += AddAnswerPtr(record, dst, ttl);
-    }
+            if (!IsFitting(dst, cached)) {
+                is_truncated = true;
+                continue;
+            }
 
-    if ((s_service_replies & ServiceReply::kSrv) == ServiceReply::kSrv) {
-        answers++;
-        dst += AddAnswerSrv(record, dst, ttl);
-    }
+            dst = PutAnswerService(dst, record_index, answer, ttl);
 
-    if ((s_service_replies & ServiceReply::kTxt) == ServiceReply::kTxt) {
-        answers++;
-        dst += AddAnswerTxt(record, dst, ttl);
+            if (!s_is_unicast) {
+                cached.millis_multicast = kMillis;
+            }
+
+            answers++;
+        }
     }
 
-    dst += AddAnswerA(dst, ttl);
+    uint32_t additionals = 0;
+
+    // The A record is additional, it is left out silently when it does not fit
+    if (IsFitting(dst, s_cached_a)) {
+        dst = PutAnswerA(dst, ttl);
+        additionals++;
+    }
 
     auto* header = reinterpret_cast<network::dns::Header*>(&s_records_data);
 
     header->xid = transaction_id;
-    header->flag1 = network::dns::Flag1::kResponse | network::dns::Flag1::kAuthorative;
+    header->flag1 = GetResponseFlag1(is_truncated);
     header->flag2 = 0;
     header->query_count = 0;
     header->answer_count = __builtin_bswap16(static_cast<uint16_t>(answers));
     header->authority_count = __builtin_bswap16(0);
-    header->additional_count = __builtin_bswap16(1);
+    header->additional_count = __builtin_bswap16(static_cast<uint16_t>(additionals));
 
     const auto kSize = static_cast<uint16_t>(dst - reinterpret_cast<uint8_t*>(header));
     Send(kSize);
@@ -741,14 +985,18 @@ void SendAnnouncement(uint32_t ttl) {
     MDNS_DEBUG_ENTRY();
 
     s_n_remote_port = network::iana::Ports::kPortMdns; // FIXME Hack ;-)
+    s_is_unicast = false;
     s_host_replies = HostReply::kA;
 
+    // The host name or the IP may have changed
+    s_is_cache_valid = false;
+
     SendAnswerLocalIpAddress(0, ttl);
 
-    for (auto& record : s_service_records) {
-        if (record.services < Services::kLastNotUsed) {
+    for (uint32_t index = 0; index < kServiceRecordsMax; index++) {
+        if (s_service_records[index].services < Services::kLastNotUsed) {
             s_service_replies = ServiceReply::kTypePtr | ServiceReply::kNamePtr | ServiceReply::kSrv | ServiceReply::kTxt;
-            SendMessage(record, 0, ttl);
+            SendMessage(index, 0, ttl);
         }
     }
 
@@ -759,7 +1007,9 @@ bool ServiceRecordAdd(const char* name, mdns::Services services, const char* tex
     MDNS_DEBUG_ENTRY();
     assert(services < mdns::Services::kLastNotUsed);
 
-    for (auto& record : s_service_records) {
+    for (uint32_t index = 0; index < kServiceRecordsMax; index++) {
+        auto& record = s_service_records[index];
+
         if (record.services == Services::kLastNotUsed) {
             if (name != nullptr) {
                 const auto kLength = std::min(kLabelMaxlen, strlen(name));
@@ -794,10 +1044,12 @@ bool ServiceRecordAdd(const char* name, mdns::Services services, const char* tex
             }
 
             s_n_remote_port = network::iana::Ports::kPortMdns; // FIXME Hack ;-)
+            s_is_unicast = false;
+            s_is_cache_valid = false;
 
             s_service_replies = ServiceReply::kTypePtr | ServiceReply::kNamePtr | ServiceReply::kSrv | ServiceReply::kTxt;
 
-            SendMessage(record, 0, kMdnsResponseTtl);
+            SendMessage(index, 0, kMdnsResponseTtl);
 
             Domain domain;
             CreateServiceDomain(domain, record, false);
@@ -816,17 +1068,24 @@ bool ServiceRecordDelete(mdns::Services service) {
     MDNS_DEBUG_ENTRY();
     assert(service < mdns::Services::kLastNotUsed);
 
-    for (auto& record : s_service_records) {
+    for (uint32_t index = 0; index < kServiceRecordsMax; index++) {
+        auto& record = s_service_records[index];
+
         if (record.services == service) {
-            SendMessage(record, 0, 0);
+            s_is_unicast = false;
+            s_service_replies = ServiceReply::kTypePtr | ServiceReply::kNamePtr | ServiceReply::kSrv | ServiceReply::kTxt;
 
-            if (record.name != nullptr) {
-                delete[] record.name;
-            }
+            SendMessage(index, 0, 0);
 
-            if (record.text_content != nullptr) {
-                delete[] record.text_content;
-            }
+            delete[] record.name;
+            delete[] record.text_content;
+
+            record.name = nullptr;
+            record.text_content = nullptr;
+            record.text_content_length = 0;
+            record.services = Services::kLastNotUsed;
+
+            s_is_cache_valid = false;
 
             MDNS_DEBUG_EXIT();
             return true;
@@ -837,10 +1096,146 @@ bool ServiceRecordDelete(mdns::Services service) {
     return false;
 }
 
-static void HandleQuestions(uint32_t questions) {
+/*
+ * RFC 6762, 7.1. Known-Answer Suppression
+ * A record is not sent when the query holds it with at least half of our TTL.
+ */
+static void HandleKnownAnswers(uint32_t offset, uint32_t known_answers, uint32_t* service_replies) {
+    MDNS_DEBUG_ENTRY();
+    MDNS_DEBUG_PRINTF("known_answers=%u", static_cast<unsigned>(known_answers));
+
+    const auto* const kEnd = &s_p_receive_buffer[s_n_bytes_received];
+
+    for (uint32_t i = 0; i < known_answers; i++) {
+        Domain owner;
+
+        const auto* result = GetDomainName(s_p_receive_buffer, &s_p_receive_buffer[offset], kEnd, owner.a_name);
+
+        if ((result == nullptr) || ((result + 10) > kEnd)) {
+            MDNS_DEBUG_EXIT();
+            return;
+        }
+
+        owner.length = GetNameLength(owner.a_name);
+
+        const auto kType = static_cast<network::dns::RRType>(__builtin_bswap16(*reinterpret_cast<const uint16_t*>(&result[0])));
+        const auto kTtl = __builtin_bswap32(*reinterpret_cast<const uint32_t*>(&result[4]));
+        const auto kDataLength = static_cast<uint32_t>(__builtin_bswap16(*reinterpret_cast<const uint16_t*>(&result[8])));
+        const auto* const kData = &result[10];
+
+        if ((kData + kDataLength) > kEnd) {
+            MDNS_DEBUG_EXIT();
+            return;
+        }
+
+        offset = static_cast<uint32_t>((kData + kDataLength) - s_p_receive_buffer);
+
+        if (kTtl < (kMdnsResponseTtl / 2)) {
+            continue;
+        }
+
+        Domain domain;
+        Domain target;
+
+        if ((kType == network::dns::RRType::kPtr) || ((kType == network::dns::RRType::kSrv) && (kDataLength > 6))) {
+            const auto* const kTarget = (kType == network::dns::RRType::kPtr) ? kData : &kData[6];
+
+            if (GetDomainName(s_p_receive_buffer, kTarget, kEnd, target.a_name) == nullptr) {
+                continue;
+            }
+
+            target.length = GetNameLength(target.a_name);
+        } else if (kType == network::dns::RRType::kA) {
+            const auto kIp = network::GetPrimaryIp();
+            CreateHostDomain(domain);
+
+            if ((kDataLength == 4) && (domain == owner) && (memcmp(kData, &kIp, 4) == 0)) {
+                s_host_replies &= ~HostReply::kA;
+            }
+            continue;
+        } else if (kType != network::dns::RRType::kTxt) {
+            continue;
+        }
+
+#if defined(CONFIG_MDNS_DOMAIN_REVERSE)
+        if (kType == network::dns::RRType::kPtr) {
+            CreateReverseDomain(domain);
+
+            if (domain == owner) {
+                CreateHostDomain(domain);
+
+                if (domain == target) {
+                    s_host_replies &= ~HostReply::kPtr;
+                }
+                continue;
+            }
+        }
+#endif
+
+        for (uint32_t index = 0; index < kServiceRecordsMax; index++) {
+            const auto& record = s_service_records[index];
+
+            if (record.services == Services::kLastNotUsed) {
+                continue;
+            }
+
+            if (kType == network::dns::RRType::kPtr) {
+                CreateServiceDomain(domain, record, false);
+
+                if (kDomainDnssd == owner) {
+                    if (domain == target) {
+                        service_replies[index] &= ~ServiceReply::kTypePtr;
+                    }
+                } else if (domain == owner) {
+                    CreateServiceDomain(domain, record, true);
+
+                    if (domain == target) {
+                        service_replies[index] &= ~ServiceReply::kNamePtr;
+                    }
+                }
+                continue;
+            }
+
+            CreateServiceDomain(domain, record, true);
+
+            if (!(domain == owner)) {
+                continue;
+            }
+
+            if (kType == network::dns::RRType::kSrv) {
+                CreateHostDomain(domain);
+
+                if ((memcmp(&kData[4], &record.port, 2) == 0) && (domain == target)) {
+                    service_replies[index] &= ~ServiceReply::kSrv;
+                }
+                continue;
+            }
+
+            // TXT, a record without text has a single empty string
+            const auto kTextLength = static_cast<uint32_t>(record.text_content_length);
+
+            if ((kDataLength == (1U + kTextLength)) && (kData[0] == kTextLength) && ((kTextLength == 0) || (memcmp(&kData[1], record.text_content, kTextLength) == 0))) {
+                service_replies[index] &= ~ServiceReply::kTxt;
+            }
+        }
+    }
+
+    MDNS_DEBUG_EXIT();
+}
+
+static bool IsRateLimited(CachedRecord const& cached, uint32_t millis) {
+    return (millis - cached.millis_multicast) < kRateLimitMillis;
+}
+
+static void HandleQuestions(uint32_t questions, uint32_t known_answers) {
     MDNS_DEBUG_ENTRY();
     MDNS_DEBUG_PRINTF("questions=%u", static_cast<unsigned>(questions));
 
+    if (questions == 0) {
+        MDNS_DEBUG_EXIT();
+        return;
+    }
+
     s_host_replies = 0;
     s_is_unicast = (s_n_remote_port != network::iana::Ports::kPortMdns);
     s_is_legacy_query = s_is_unicast && (questions == 1);
@@ -848,18 +1243,20 @@ static void HandleQuestions(uint32_t questions) {
     const auto kTransactionID = s_is_legacy_query ? *reinterpret_cast<uint16_t*>(&s_p_receive_buffer[0]) : static_cast<uint16_t>(0);
 
     uint32_t offset = sizeof(struct network::dns::Header);
+    uint32_t service_replies[kServiceRecordsMax] = {};
 
     for (uint32_t i = 0; i < questions; i++) {
         Domain resource_domain;
 
         auto* result = GetDomainName(s_p_receive_buffer, &s_p_receive_buffer[offset], &s_p_receive_buffer[s_n_bytes_received], resource_domain.a_name);
-        if (result == nullptr) {
+        if ((result == nullptr) || ((result + 4) > &s_p_receive_buffer[s_n_bytes_received])) {
             MDNS_DEBUG_EXIT();
             return;
         }
 
-        resource_domain.length = static_cast<uint16_t>(result - &s_p_receive_buffer[offset]);
-        offset += resource_domain.length;
+        // The name can be compressed, so its length is not the number of bytes read
+        resource_domain.length = GetNameLength(resource_domain.a_name);
+        offset = static_cast<uint32_t>(result - s_p_receive_buffer);
 
         const auto kType = static_cast<network::dns::RRType>(__builtin_bswap16(*reinterpret_cast<uint16_t*>(&s_p_receive_buffer[offset])));
         offset += 2;
@@ -902,26 +1299,28 @@ static void HandleQuestions(uint32_t questions) {
         }
 #endif
 
-        for (auto& record : s_service_records) {
+        for (uint32_t index = 0; index < kServiceRecordsMax; index++) {
+            const auto& record = s_service_records[index];
+
             if (record.services < Services::kLastNotUsed) {
                 /*
                  * Check service
                  */
 
-                s_service_replies = 0;
+                uint32_t replies = 0;
                 Domain service_domain;
 
                 if (kType == network::dns::RRType::kPtr || kType == network::dns::RRType::kAll) {
                     if (kDomainDnssd == resource_domain) {
-                        s_service_replies = s_service_replies | ServiceReply::kTypePtr;
+                        replies = replies | ServiceReply::kTypePtr;
                     }
 
                     CreateServiceDomain(service_domain, record, false);
 
                     if (service_domain == resource_domain) {
-                        s_service_replies = s_service_replies | ServiceReply::kNamePtr;
-                        s_service_replies = s_service_replies | ServiceReply::kSrv;
-                        s_service_replies = s_service_replies | ServiceReply::kTxt;
+                        replies = replies | ServiceReply::kNamePtr;
+                        replies = replies | ServiceReply::kSrv;
+                        replies = replies | ServiceReply::kTxt;
                     }
                 }
 
@@ -929,19 +1328,58 @@ static void HandleQuestions(uint32_t questions) {
 
                 if (service_domain == resource_domain) {
                     if ((kType == network::dns::RRType::kSrv) || (kType == network::dns::RRType::kAll)) {
-                        s_service_replies = s_service_replies | ServiceReply::kSrv;
+                        replies = replies | ServiceReply::kSrv;
                     }
 
                     if ((kType == network::dns::RRType::kTxt) || (kType == network::dns::RRType::kAll)) {
-                        s_service_replies = s_service_replies | ServiceReply::kTxt;
+                        replies = replies | ServiceReply::kTxt;
                     }
                 }
 
-                if (s_service_replies != 0) {
-                    SendMessage(record, kTransactionID, kMdnsResponseTtl);
+                service_replies[index] |= replies;
+            }
+        }
+    }
+
+    if (known_answers != 0) {
+        HandleKnownAnswers(offset, known_answers, service_replies);
+    }
+
+    /*
+     * One reply per service for all the questions in the query.
+     * A multicast record is not sent again within a second.
+     */
+    const auto kMillis = timing::Millis();
+
+    for (uint32_t index = 0; index < kServiceRecordsMax; index++) {
+        s_service_replies = service_replies[index];
+
+        if (s_service_replies == 0) {
+            continue;
+        }
+
+        if (!s_is_unicast) {
+            for (uint32_t answer = 0; answer < kServiceAnswers; answer++) {
+                if (IsRateLimited(s_cached_service[index][answer], kMillis)) {
+                    s_service_replies &= ~(ServiceReply::kTypePtr << answer);
                 }
             }
         }
+
+        if (s_service_replies != 0) {
+            SendMessage(index, kTransactionID, kMdnsResponseTtl);
+        }
+    }
+
+    if (!s_is_unicast) {
+        if (IsRateLimited(s_cached_a, kMillis)) {
+            s_host_replies &= ~HostReply::kA;
+        }
+#if defined(CONFIG_MDNS_DOMAIN_REVERSE)
+        if (IsRateLimited(s_cached_reverse, kMillis)) {
+            s_host_replies &= ~HostReply::kPtr;
+        }
+#endif
     }
 
     if (s_host_replies != 0) {
@@ -965,7 +1403,7 @@ static void Input(const uint8_t* buffer, uint32_t size, uint32_t from_ip, uint16
         return;
     }
 
-    HandleQuestions(static_cast<uint32_t>(__builtin_bswap16(kHeader->query_count)));
+    HandleQuestions(static_cast<uint32_t>(__builtin_bswap16(kHeader->query_count)), static_cast<uint32_t>(__builtin_bswap16(kHeader->answer_count)));
 }
 
 void Init() {
@@ -975,6 +1413,20 @@ void Init() {
         record.services = Services::kLastNotUsed;
     }
 
+    // Do not rate limit the replies in the first second after boot
+    const auto kMillis = timing::Millis() - kRateLimitMillis;
+
+    for (auto& cached_service : s_cached_service) {
+        for (auto& cached : cached_service) {
+            cached.millis_multicast = kMillis;
+        }
+    }
+
+    s_cached_a.millis_multicast = kMillis;
+#if defined(CONFIG_MDNS_DOMAIN_REVERSE)
+    s_cached_reverse.millis_multicast = kMillis;
+#endif
+
     s_handle = network::udp::Begin(network::iana::Ports::kPortMdns, Input);
     assert(s_handle != -1);
 
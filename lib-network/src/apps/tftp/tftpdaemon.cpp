@@ -25,6 +25,10 @@
 
 /*
  * https://tools.ietf.org/html/rfc1350
+ * https://tools.ietf.org/html/rfc2347 Option Extension
+ * https://tools.ietf.org/html/rfc2348 Blocksize Option
+ * https://tools.ietf.org/html/rfc2349 Transfer Size Option
+ * https://tools.ietf.org/html/rfc7440 Windowsize Option
  */
 
 #include <cstdint>
@@ -34,6 +38,8 @@
 #include "network_udp.h"
 #include "apps/tftpdaemon.h"
 #include "core/protocol/iana.h"
+#include "core/protocol/udp.h"
+#include "timing.h"
 #include "firmware/debug/debug_debug.h"
 
 #if defined(DEBUG_NET_APPS_TFTP)
@@ -61,6 +67,7 @@ static constexpr uint16_t kOpCodeWrq = 2;   ///< Write request (WRQ)
 static constexpr uint16_t kOpCodeData = 3;  ///< Data (DATA)
 static constexpr uint16_t kOpCodeAck = 4;   ///< Acknowledgment (ACK)
 static constexpr uint16_t kOpCodeError = 5; ///< Error (ERROR)
+static constexpr uint16_t kOpCodeOack = 6;  ///< Option acknowledgment (OACK)
 
 static constexpr uint16_t kErrorCodeOther = 0;    ///< Not defined, see error message (if any).
 static constexpr uint16_t kErrorCodeNoFile = 1;   ///< File not found.
@@ -80,10 +87,19 @@ namespace max {
 static constexpr uint32_t kFilenameLen = 128;
 static constexpr uint32_t kModeLen = 16;
 static constexpr uint32_t kFilenameModeLen = (kFilenameLen + 1 + kModeLen + 1);
-static constexpr uint32_t kDataLen = 512;
+static constexpr uint32_t kDataLen = 512;    ///< RFC 1350 block size
+static constexpr uint32_t kBlockSize = 1428; ///< Negotiated block size
+static constexpr uint32_t kWindowSize = 16;  ///< Negotiated window size (write requests only)
 static constexpr uint32_t kErrmsgLen = 128;
+static constexpr uint32_t kOptionAckLen = 64;
 } // namespace max
 
+namespace option {
+static constexpr uint8_t kBlockSize = (1U << 0);
+static constexpr uint8_t kWindowSize = (1U << 1);
+static constexpr uint8_t kTransferSize = (1U << 2);
+} // namespace option
+
 #if !defined(PACKED)
 #define PACKED __attribute__((packed))
 #endif
@@ -107,8 +123,48 @@ struct ErrorPacket {
 struct DataPacket {
     uint16_t op_code;
     uint16_t block_number;
-    uint8_t data[max::kDataLen];
+    uint8_t data[max::kBlockSize];
 } PACKED;
+
+static_assert(sizeof(struct DataPacket) <= network::udp::kDataSize);
+
+static bool ParseNumber(const char* s, uint32_t& value) {
+    value = 0;
+
+    if (*s == '\0') {
+        return false;
+    }
+
+    while (*s != '\0') {
+        if ((*s < '0') || (*s > '9') || (value > (UINT32_MAX / 10U))) {
+            return false;
+        }
+        value = (value * 10U) + static_cast<uint32_t>(*s++ - '0');
+    }
+
+    return true;
+}
+
+static uint8_t* AppendOption(uint8_t* p, const char* name, uint32_t value) {
+    while (*name != '\0') {
+        *p++ = static_cast<uint8_t>(*name++);
+    }
+    *p++ = '\0';
+
+    char digits[10];
+    uint32_t n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + (value % 10U));
+        value /= 10U;
+    } while (value != 0);
+
+    while (n != 0) {
+        *p++ = static_cast<uint8_t>(digits[--n]);
+    }
+    *p++ = '\0';
+
+    return p;
+}
 } // namespace tftp
 
 TFTPDaemon::TFTPDaemon() {
@@ -152,6 +208,12 @@ void TFTPDaemon::Init() {
 
     from_port_ = network::iana::Ports::kPortTftp;
     block_number_ = 0;
+    block_size_ = tftp::max::kDataLen;
+    window_size_ = 1;
+    window_count_ = 0;
+    gap_count_ = 0;
+    options_ = 0;
+    transfer_size_ = 0;
     state_ = State::kWaitingRq;
     is_last_block_ = false;
 
@@ -179,7 +241,7 @@ void TFTPDaemon::Input(const uint8_t* buffer, uint32_t size, uint32_t from_ip, u
             }
             break;
         case State::kWrqRecvPacket:
-            if (length_ <= sizeof(struct tftp::DataPacket)) {
+            if (length_ <= (4U + block_size_)) {
                 HandleRecvData();
             }
             break;
@@ -202,14 +264,16 @@ void TFTPDaemon::HandleRequest() {
     }
 
     const char* const kFileName = kPacket->file_name_mode;
-    const auto kFileNameLength = strlen(kFileName);
+    const char* const kEnd = reinterpret_cast<const char*>(buffer_) + length_;
+    const auto kFileNameLength = strnlen(kFileName, static_cast<size_t>(kEnd - kFileName));
 
-    if (!(1 <= kFileNameLength && kFileNameLength <= tftp::max::kFilenameLen)) {
+    if (!(1 <= kFileNameLength && kFileNameLength <= tftp::max::kFilenameLen) || (&kFileName[kFileNameLength + 1] >= kEnd)) {
         SendError(kErrorCodeOther, "Invalid file name");
         return;
     }
 
     const char* const kMode = &kPacket->file_name_mode[kFileNameLength + 1];
+    const auto kModeLength = strnlen(kMode, static_cast<size_t>(kEnd - kMode));
     tftp::Mode mode;
 
     if (strncmp(kMode, "octet", 5) == 0) {
@@ -223,6 +287,22 @@ void TFTPDaemon::HandleRequest() {
 
     TFTP_DEBUG_PRINTF("Incoming %s request from " IPSTR " %s %s", kOpCode == kOpCodeRrq ? "read" : "write", IP2STR(from_ip_), kFileName, kMode);
 
+    block_size_ = tftp::max::kDataLen;
+    window_size_ = 1;
+    window_count_ = 0;
+    gap_count_ = 0;
+    options_ = 0;
+    transfer_size_ = 0;
+
+    const char* const kOptions = &kMode[kModeLength + 1];
+
+    if (kOptions < kEnd) {
+        ParseOptions(kOptions, kEnd, kOpCode == kOpCodeRrq);
+    }
+
+    statistics_ = tftp::Statistics{};
+    start_millis_ = timing::Millis();
+
     switch (kOpCode) {
         case kOpCodeRrq:
             if (!FileOpen(kFileName, mode)) {
@@ -231,8 +311,24 @@ void TFTPDaemon::HandleRequest() {
             } else {
                 network::udp::End(network::iana::Ports::kPortTftp);
                 index_ = network::udp::Begin(from_port_, TFTPDaemon::StaticCallbackFunction);
-                state_ = State::kRrqSendPacket;
-                DoRead();
+
+                if ((options_ & tftp::option::kTransferSize) != 0) {
+                    transfer_size_ = static_cast<uint32_t>(FileSize());
+                    if (transfer_size_ == 0) {
+                        options_ &= static_cast<uint8_t>(~tftp::option::kTransferSize);
+                    }
+                }
+
+                if (options_ != 0) {
+                    // The client acknowledges the OACK with block number 0
+                    block_number_ = 0;
+                    is_last_block_ = false;
+                    state_ = State::kRrqRecvAck;
+                    SendOptionAck();
+                } else {
+                    state_ = State::kRrqSendPacket;
+                    DoRead();
+                }
             }
             break;
         case kOpCodeWrq:
@@ -242,8 +338,16 @@ void TFTPDaemon::HandleRequest() {
             } else {
                 network::udp::End(network::iana::Ports::kPortTftp);
                 index_ = network::udp::Begin(from_port_, TFTPDaemon::StaticCallbackFunction);
-                state_ = State::kWrqSendAck;
-                DoWriteAck();
+
+                if (options_ != 0) {
+                    // The OACK replaces the ACK for block number 0
+                    block_number_ = 0;
+                    state_ = State::kWrqRecvPacket;
+                    SendOptionAck();
+                } else {
+                    state_ = State::kWrqSendAck;
+                    DoWriteAck();
+                }
             }
             break;
         default:
@@ -253,6 +357,72 @@ void TFTPDaemon::HandleRequest() {
     }
 }
 
+void TFTPDaemon::ParseOptions(const char* options, const char* end, bool is_read_request) {
+    while (options < end) {
+        const auto kNameLength = strnlen(options, static_cast<size_t>(end - options));
+        const char* const kValue = &options[kNameLength + 1];
+
+        if (kValue >= end) {
+            return;
+        }
+
+        const auto kValueLength = strnlen(kValue, static_cast<size_t>(end - kValue));
+
+        if (&kValue[kValueLength] >= end) {
+            return;
+        }
+
+        uint32_t value;
+
+        if (tftp::ParseNumber(kValue, value)) {
+            if (strcasecmp(options, "blksize") == 0) {
+                if (value >= 8) {
+                    block_size_ = static_cast<uint16_t>(value < tftp::max::kBlockSize ? value : tftp::max::kBlockSize);
+                    options_ |= tftp::option::kBlockSize;
+                }
+            } else if (strcasecmp(options, "windowsize") == 0) {
+                // A window needs random access for retransmission, FileRead is sequential
+                if ((value >= 1) && !is_read_request) {
+                    window_size_ = static_cast<uint16_t>(value < tftp::max::kWindowSize ? value : tftp::max::kWindowSize);
+                    options_ |= tftp::option::kWindowSize;
+                }
+            } else if (strcasecmp(options, "tsize") == 0) {
+                transfer_size_ = value;
+                options_ |= tftp::option::kTransferSize;
+            }
+        }
+
+        TFTP_DEBUG_PRINTF("%s=%s", options, kValue);
+
+        options = &kValue[kValueLength + 1];
+    }
+}
+
+void TFTPDaemon::SendOptionAck() {
+    uint8_t packet[tftp::max::kOptionAckLen];
+
+    packet[0] = 0;
+    packet[1] = static_cast<uint8_t>(kOpCodeOack);
+
+    auto* p = &packet[2];
+
+    if ((options_ & tftp::option::kBlockSize) != 0) {
+        p = tftp::AppendOption(p, "blksize", block_size_);
+    }
+
+    if ((options_ & tftp::option::kWindowSize) != 0) {
+        p = tftp::AppendOption(p, "windowsize", window_size_);
+    }
+
+    if ((options_ & tftp::option::kTransferSize) != 0) {
+        p = tftp::AppendOption(p, "tsize", transfer_size_);
+    }
+
+    TFTP_DEBUG_PRINTF("blksize=%u, windowsize=%u, tsize=%u", static_cast<unsigned>(block_size_), static_cast<unsigned>(window_size_), static_cast<unsigned>(transfer_size_));
+
+    network::udp::Send(index_, packet, static_cast<uint32_t>(p - packet), from_ip_, from_port_);
+}
+
 void TFTPDaemon::SendError(uint16_t error_code, const char* error_message) {
     tftp::ErrorPacket error_packet;
 
@@ -268,13 +438,16 @@ void TFTPDaemon::DoRead() {
     assert(kDataPacket != nullptr);
 
     if (state_ == State::kRrqSendPacket) {
-        data_length_ = FileRead(kDataPacket->data, tftp::max::kDataLen, ++block_number_);
+        data_length_ = FileRead(kDataPacket->data, block_size_, ++block_number_);
 
         kDataPacket->op_code = __builtin_bswap16(kOpCodeData);
         kDataPacket->block_number = __builtin_bswap16(block_number_);
 
         packet_length_ = sizeof kDataPacket->op_code + sizeof kDataPacket->block_number + data_length_;
-        is_last_block_ = data_length_ < tftp::max::kDataLen;
+        is_last_block_ = data_length_ < block_size_;
+
+        statistics_.bytes += data_length_;
+        statistics_.blocks++;
 
         if (is_last_block_) {
             FileClose();
@@ -298,7 +471,16 @@ void TFTPDaemon::HandleRecvAck() {
         TFTP_DEBUG_PRINTF("Incoming from " IPSTR ", block_number=%d, block_number_=%d", IP2STR(from_ip_), __builtin_bswap16(kAckPacket->block_number), block_number_);
 
         if (kAckPacket->block_number == __builtin_bswap16(block_number_)) {
-            state_ = is_last_block_ ? State::kInit : State::kRrqSendPacket;
+            if (is_last_block_) {
+                statistics_.millis = timing::Millis() - start_millis_;
+                state_ = State::kInit;
+                Init();
+                return;
+            }
+
+            // Send the next block right away, do not wait for the client to retransmit
+            state_ = State::kRrqSendPacket;
+            DoRead();
         }
     }
 }
@@ -324,23 +506,51 @@ void TFTPDaemon::HandleRecvData() {
     const auto* const kDataPacket = reinterpret_cast<struct tftp::DataPacket*>(buffer_);
     assert(kDataPacket != nullptr);
 
-    if (kDataPacket->op_code == __builtin_bswap16(kOpCodeData)) {
-        data_length_ = length_ - 4;
-        block_number_ = __builtin_bswap16(kDataPacket->block_number);
+    if (kDataPacket->op_code != __builtin_bswap16(kOpCodeData)) {
+        return;
+    }
 
-        TFTP_DEBUG_PRINTF("Incoming from " IPSTR ", length_=%u, block_number_=%u, data_length_=%u", IP2STR(from_ip_), static_cast<unsigned>(length_), static_cast<unsigned>(block_number_), static_cast<unsigned>(data_length_));
+    const auto kBlockNumber = __builtin_bswap16(kDataPacket->block_number);
 
-        if (data_length_ == FileWrite(kDataPacket->data, data_length_, block_number_)) {
-            if (data_length_ < tftp::max::kDataLen) {
-                is_last_block_ = true;
-                FileClose();
-            }
+    // Block numbers roll over to 0
+    if (kBlockNumber != static_cast<uint16_t>(block_number_ + 1U)) {
+        statistics_.duplicates++;
+        window_count_ = 0;
 
+        // Acknowledge the last block received in sequence; the sender continues from there.
+        // Once per window, otherwise the rest of a broken window triggers a retransmission each.
+        if ((gap_count_++ % window_size_) == 0) {
             DoWriteAck();
-        } else {
-            SendError(kErrorCodeDiskFull, "Write failed");
-            state_ = State::kInit;
-            Init();
         }
+        return;
+    }
+
+    gap_count_ = 0;
+    data_length_ = length_ - 4;
+
+    TFTP_DEBUG_PRINTF("Incoming from " IPSTR ", length_=%u, block_number=%u, data_length_=%u", IP2STR(from_ip_), static_cast<unsigned>(length_), static_cast<unsigned>(kBlockNumber), static_cast<unsigned>(data_length_));
+
+    if (data_length_ != FileWrite(kDataPacket->data, data_length_, kBlockNumber)) {
+        SendError(kErrorCodeDiskFull, "Write failed");
+        state_ = State::kInit;
+        Init();
+        return;
+    }
+
+    block_number_ = kBlockNumber;
+    statistics_.bytes += data_length_;
+    statistics_.blocks++;
+
+    if (data_length_ < block_size_) {
+        is_last_block_ = true;
+        statistics_.millis = timing::Millis() - start_millis_;
+        FileClose();
+        DoWriteAck();
+        return;
+    }
+
+    if (++window_count_ >= window_size_) {
+        window_count_ = 0;
+        DoWriteAck();
     }
 }
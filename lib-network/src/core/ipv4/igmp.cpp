@@ -302,8 +302,15 @@ static void DelayingMember(struct GroupInfo& group, uint32_t maxresp) {
 }
 
 #if defined(CONFIG_EMAC_HASH_MULTICAST_FILTER)
-static void ResetHash() {
+/*
+ * The first groups get an exact (perfect) MAC filter slot,
+ * the remaining groups share the 64-bit hash filter.
+ */
+static void UpdateFilter() {
     emac::multicast::ResetHash();
+    emac::multicast::ResetPerfect();
+
+    uint32_t slot = 0;
 
     for (auto& group : s_groups) {
         if (group.group_address != 0) {
@@ -311,7 +318,11 @@ static void ResetHash() {
             multicast_ip.u32 = group.group_address;
             const uint8_t kMacAddr[6] = {0x01, 0x00, 0x5E, static_cast<uint8_t>(multicast_ip.u8[1] & 0x7F), multicast_ip.u8[2], multicast_ip.u8[3]};
 
-            emac::multicast::SetHash(kMacAddr);
+            if (slot < emac::multicast::kPerfectSlots) {
+                emac::multicast::SetPerfect(slot++, kMacAddr);
+            } else {
+                emac::multicast::SetHash(kMacAddr);
+            }
         }
     }
 }
@@ -338,11 +349,7 @@ void static Join(uint32_t group_address) {
             s_groups[i].timer = 2; // TODO(avv):
 
 #if defined(CONFIG_EMAC_HASH_MULTICAST_FILTER)
-            pcast32 multicast_ip;
-            multicast_ip.u32 = group_address;
-            const uint8_t kMacAddr[6] = {0x01, 0x00, 0x5E, static_cast<uint8_t>(multicast_ip.u8[1] & 0x7F), multicast_ip.u8[2], multicast_ip.u8[3]};
-            IGMP_DEBUG_PRINTF(MACSTR, MAC2STR(kMacAddr));
-            emac::multicast::SetHash(kMacAddr);
+            UpdateFilter();
 #endif
             SendReport(group_address);
 
@@ -368,7 +375,7 @@ static void Leave(uint32_t group_address) {
             group.timer = 0;
 
 #if defined(CONFIG_EMAC_HASH_MULTICAST_FILTER)
-            ResetHash();
+            UpdateFilter();
 #endif
             IGMP_DEBUG_EXIT();
             return;
@@ -49,6 +49,8 @@ void SendTimestamp(uint32_t);
 void SendTimestamp(void*, uint32_t);
 #endif
 uint32_t Recv(uint8_t**);
+bool RecvIsFull();
+uint32_t RecvPeek(uint32_t, uint8_t**);
 void FreePkt();
 } // namespace emac::eth
 
@@ -1651,11 +1651,13 @@ int32_t Send(ConnHandle conn_handle, const uint8_t* buffer, uint32_t length) {
     TCP_DEBUG_PRINTF("%u -> %u", static_cast<unsigned>(conn_handle), static_cast<unsigned>(length));
 
     const auto* p = buffer;
+    auto& queue = tcb->tx_queue;
 
     // Legacy behavior preserved:
     // Only send if the FULL remaining length fits inside SND.WND.
     // NOTE: Many stacks instead send min(length, wnd)
-    while ((length > 0) && (length <= tcb->SND.WND)) {
+    // Data already queued goes first, otherwise the byte stream gets reordered.
+    while (queue.IsEmpty() && (length > 0) && (length <= tcb->SND.WND)) {
         const uint32_t kWriteLen = (length > kTcpDataMss) ? kTcpDataMss : length;
         const bool kIsLast = (length < kTcpDataMss);
 
@@ -1670,26 +1672,17 @@ int32_t Send(ConnHandle conn_handle, const uint8_t* buffer, uint32_t length) {
         return 0; // everything sent immediately
     }
 
-    auto& queue = tcb->tx_queue;
-
-    if (!queue.IsEmpty()) {
-        // Already queued something.
-        TCP_DEBUG_EXIT();
-        return -2;
-    }
-
+    // Append behind anything already queued (streamed responses send several times)
     while (length > 0) {
-        if (queue.IsFull()) {
+        const uint32_t kWriteLen = (length > kTcpDataMss) ? kTcpDataMss : length;
+        const bool kIsLast = (length < kTcpDataMss);
+
+        if (!queue.Push(p, kWriteLen, kIsLast)) {
             // Can't queue everything.
             TCP_DEBUG_EXIT();
             return -2;
         }
 
-        const uint32_t kWriteLen = (length > kTcpDataMss) ? kTcpDataMss : length;
-        const bool kIsLast = (length < kTcpDataMss);
-
-        queue.Push(p, kWriteLen, kIsLast);
-
         p += kWriteLen;
         length -= kWriteLen;
     }
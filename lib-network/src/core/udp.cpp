@@ -68,6 +68,7 @@ namespace network::udp {
 struct PortInfo {
     UdpCallbackFunctionPtr callback;
     uint16_t port;
+    UdpZeroCopyFunctionPtr is_zero_copy;
 };
 
 struct Data {
@@ -115,6 +116,13 @@ __attribute__((hot)) void Input(const struct Header* udp) {
             const auto kDataLength = __builtin_bswap16(udp->udp.len) - kHeaderSize;
             const auto kSize = std::min(kDataSize, kDataLength);
 
+            if ((info.is_zero_copy != nullptr) && info.is_zero_copy(udp->udp.data, kSize)) {
+                // The descriptor is released after the callback
+                info.callback(udp->udp.data, kSize, network::MemcpyIp(udp->ip4.src), __builtin_bswap16(udp->udp.source_port));
+                emac::eth::FreePkt();
+                return;
+            }
+
             std::memcpy(data.data, udp->udp.data, kSize);
             data.from_ip = network::MemcpyIp(udp->ip4.src);
             data.from_port = __builtin_bswap16(udp->udp.source_port);
@@ -215,7 +223,7 @@ template <network::arp::EthSend S> static void SendImplementation(int index, con
 #endif
 }
 
-int32_t Begin(uint16_t localport, UdpCallbackFunctionPtr callback) {
+int32_t Begin(uint16_t localport, UdpCallbackFunctionPtr callback, UdpZeroCopyFunctionPtr is_zero_copy) {
     UDP_DEBUG_PRINTF("localport=%u", static_cast<unsigned>(localport));
 
     for (auto i = 0; i < UDP_MAX_PORTS_ALLOWED; i++) {
@@ -228,6 +236,7 @@ int32_t Begin(uint16_t localport, UdpCallbackFunctionPtr callback) {
         if (info.port == 0) {
             info.callback = callback;
             info.port = localport;
+            info.is_zero_copy = (callback != nullptr) ? is_zero_copy : nullptr;
 
             UDP_DEBUG_PRINTF("i=%d, localport=%d[%x], callback=%p", static_cast<int>(i), static_cast<unsigned>(localport), static_cast<unsigned>(localport), reinterpret_cast<void*>(callback));
             return i;
@@ -247,6 +256,7 @@ int32_t End(uint16_t localport) {
         if (info.port == localport) {
             info.callback = nullptr;
             info.port = 0;
+            info.is_zero_copy = nullptr;
 
             auto& data = s_ports[i].data;
             data.size = 0;
@@ -0,0 +1,315 @@
+/**
+ * @file emac_rx.cpp
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#if !defined(CONFIG_REMOTECONFIG_MINIMUM)
+#pragma GCC push_options
+#pragma GCC optimize("O3")
+#pragma GCC optimize("no-tree-loop-distribute-patterns")
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+
+#include "emac/emac_rx.h"
+#include "../src/core/network_private.h"
+#include "network_iface.h"
+#include "core/protocol/ieee.h"
+#include "core/protocol/ethernet.h"
+#include "core/protocol/ip4.h"
+#include "core/protocol/udp.h"
+#include "core/protocol/iana.h"
+#include "timing.h"
+
+#if defined(CONFIG_NET_ENABLE_PTP)
+namespace net::globals::ptp {
+extern uint32_t timestamp[2];
+} // namespace net::globals::ptp
+#endif
+
+namespace emac::rx {
+namespace {
+#if defined(CONFIG_EMAC_RX_QUEUE_SIZE)
+struct Frame {
+    uint32_t length;
+    uint32_t micros; ///< Queued at
+    Class c;
+#if defined(CONFIG_NET_ENABLE_PTP)
+    uint32_t timestamp[2];
+#endif
+    alignas(uint32_t) uint8_t data[kQueueFrameSize];
+};
+
+static_assert(kQueueSize != 0);
+
+Frame s_queue[kQueueSize];
+uint32_t s_head; ///< Free running, next frame to queue
+uint32_t s_tail; ///< Free running, next frame to process
+#endif
+
+Counters s_counters[kClasses];
+uint32_t s_deferred_micros;
+bool s_is_deferred;
+bool s_is_queued_frame;
+
+using network::iana::Ports;
+
+Class ClassifyArtNet(const network::udp::Header* udp) {
+    // "Art-Net\0" followed by the OpCode, little endian
+    const auto kOpCode = static_cast<uint16_t>(udp->udp.data[8] | (udp->udp.data[9] << 8));
+
+    switch (kOpCode) {
+        case 0x5000: // OpDmx
+        case 0x5100: // OpNzs
+        case 0x5200: // OpSync
+            return Class::kDmx;
+        default:
+            return Class::kControl;
+    }
+}
+} // namespace
+
+Class Classify(const uint8_t* frame) {
+    const auto* const kEther = reinterpret_cast<const network::ethernet::Header*>(frame);
+
+    switch (kEther->type) {
+        case __builtin_bswap16(network::ethernet::Type::kIPv4):
+            break;
+        case __builtin_bswap16(network::ethernet::Type::kArp):
+        case __builtin_bswap16(network::ethernet::Type::kPtp):
+            return Class::kControl;
+        default:
+            return Class::kOther;
+    }
+
+    const auto* const kIp4 = reinterpret_cast<const network::ip4::Header*>(frame);
+
+    if (kIp4->ip4.proto == network::ip4::Proto::kIgmp) {
+        return Class::kControl;
+    }
+
+    if (kIp4->ip4.proto != network::ip4::Proto::kUdp) {
+        return Class::kOther;
+    }
+
+    const auto* const kUdp = reinterpret_cast<const network::udp::Header*>(frame);
+
+    switch (__builtin_bswap16(kUdp->udp.destination_port)) {
+        case Ports::kPortArtNet:
+            return ClassifyArtNet(kUdp);
+        case Ports::kPortSacn:
+        case Ports::kPortDdp:
+            return Class::kDmx;
+        case Ports::kPortLlrp:
+            return Class::kControl;
+        default:
+            return Class::kOther;
+    }
+}
+
+namespace {
+void UpdateLatency(Counters& counters, uint32_t micros) {
+    const auto kLatency = timing::Micros() - micros;
+    if (kLatency > counters.latency_max_us) {
+        counters.latency_max_us = kLatency;
+    }
+}
+
+void Input(uint8_t* frame, uint32_t length, Counters& counters) {
+    counters.received++;
+
+    // NOTE: emac::eth::FreePkt() is done in EthernetInput
+    network::iface::EthernetInput(frame, length);
+}
+
+/*
+ * A control or other frame is only taken out of order for a DMX frame received behind it.
+ */
+bool IsDmxPending() {
+    uint8_t* frame;
+
+    for (uint32_t n = 1; emac::eth::RecvPeek(n, &frame) != 0; n++) {
+        if (Classify(frame) == Class::kDmx) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#if defined(CONFIG_EMAC_RX_QUEUE_SIZE)
+bool IsQueueEmpty() {
+    return s_head == s_tail;
+}
+
+/*
+ * Copies the frame out of the Rx ring and releases the descriptor.
+ */
+bool Enqueue(const uint8_t* data, uint32_t length, Class c) {
+    if (((s_head - s_tail) == kQueueSize) || (length > kQueueFrameSize)) {
+        return false;
+    }
+
+    auto& frame = s_queue[s_head & (kQueueSize - 1)];
+    memcpy(frame.data, data, length);
+    frame.length = length;
+    frame.micros = timing::Micros();
+    frame.c = c;
+
+    s_head++;
+
+    emac::eth::FreePkt();
+
+#if defined(CONFIG_NET_ENABLE_PTP)
+    // FreePkt has taken the receive time stamp of this frame
+    frame.timestamp[0] = net::globals::ptp::timestamp[0];
+    frame.timestamp[1] = net::globals::ptp::timestamp[1];
+#endif
+
+    return true;
+}
+
+// The queued frames are older than anything in the ring, without a budget all are processed
+void RunQueue(uint32_t* budget) {
+    while (s_head != s_tail) {
+        auto& frame = s_queue[s_tail & (kQueueSize - 1)];
+        const auto kIndex = static_cast<uint32_t>(frame.c);
+        auto& counters = s_counters[kIndex];
+
+        if (budget == nullptr) {
+            counters.forced++;
+        } else if (budget[kIndex] == 0) {
+            break;
+        } else {
+            budget[kIndex]--;
+        }
+
+        UpdateLatency(counters, frame.micros);
+
+        s_is_queued_frame = true;
+        Input(frame.data, frame.length, counters);
+        assert(!s_is_queued_frame);
+
+        s_tail++;
+    }
+}
+#else
+constexpr bool IsQueueEmpty() {
+    return true;
+}
+
+constexpr bool Enqueue([[maybe_unused]] const uint8_t* data, [[maybe_unused]] uint32_t length, [[maybe_unused]] Class c) {
+    return false;
+}
+
+void RunQueue([[maybe_unused]] uint32_t* budget) {}
+#endif
+} // namespace
+
+void Run() {
+    uint32_t budget[kClasses] = {kBudgetDmx, kBudgetControl, kBudgetOther};
+
+    RunQueue(budget);
+
+    uint8_t* frame;
+    uint32_t length;
+
+    while ((length = emac::eth::Recv(&frame)) > 0) {
+        const auto kClass = Classify(frame);
+        const auto kIndex = static_cast<uint32_t>(kClass);
+        auto& counters = s_counters[kIndex];
+
+        if (kClass == Class::kDmx) {
+            if (budget[kIndex] == 0) {
+                if (!emac::eth::RecvIsFull()) {
+                    if (!s_is_deferred) {
+                        s_is_deferred = true;
+                        s_deferred_micros = timing::Micros();
+                        counters.deferred++;
+                    }
+
+                    return;
+                }
+
+                counters.forced++;
+            } else {
+                budget[kIndex]--;
+            }
+
+            if (s_is_deferred) {
+                s_is_deferred = false;
+                UpdateLatency(counters, s_deferred_micros);
+            }
+
+            Input(frame, length, counters);
+            continue;
+        }
+
+        // In arrival order: only when nothing of the control or other classes is waiting
+        if ((budget[kIndex] != 0) && IsQueueEmpty()) {
+            budget[kIndex]--;
+            Input(frame, length, counters);
+            continue;
+        }
+
+        if (IsDmxPending()) {
+            // Out of the ring, so that the DMX frames behind it are reached
+            if (Enqueue(frame, length, kClass)) {
+                counters.deferred++;
+                continue;
+            }
+        } else if (!emac::eth::RecvIsFull()) {
+            // Nothing is waiting for it, it stays in the ring until the next iteration
+            return;
+        }
+
+        // Beyond the budget, after the frames queued before it
+        RunQueue(nullptr);
+
+        counters.forced++;
+        Input(frame, length, counters);
+    }
+}
+
+bool IsQueuedFrame() {
+    return s_is_queued_frame;
+}
+
+void FreeQueuedFrame() {
+    assert(s_is_queued_frame);
+    s_is_queued_frame = false;
+
+#if defined(CONFIG_NET_ENABLE_PTP) && defined(CONFIG_EMAC_RX_QUEUE_SIZE)
+    const auto& frame = s_queue[s_tail & (kQueueSize - 1)];
+    net::globals::ptp::timestamp[0] = frame.timestamp[0];
+    net::globals::ptp::timestamp[1] = frame.timestamp[1];
+#endif
+}
+
+const Counters& GetCounters(Class c) {
+    assert(c < Class::kUndefined);
+    return s_counters[static_cast<uint32_t>(c)];
+}
+} // namespace emac::rx
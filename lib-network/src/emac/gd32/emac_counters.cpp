@@ -30,6 +30,8 @@
 #include "gd32.h" // IWYU pragma: keep
 
 namespace network::iface {
+uint32_t MulticastDropped();
+
 static uint32_t s_rx_fifo_drop_total = 0;
 static uint32_t s_rx_dma_missed_total = 0;
 
@@ -61,6 +63,7 @@ void GetCounters(Counters& counters) {
     counters.rx.ovr = s_rx_fifo_drop_total;
     // Optional: track CRC, length, descriptor errors, keep 0.
     counters.rx.err = 0;
+    counters.rx.mc_drp = MulticastDropped();
 
     // Transmit
     counters.tx.ok = emac::eth::globals::counter.sent;
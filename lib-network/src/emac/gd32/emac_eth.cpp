@@ -40,6 +40,7 @@
 #include "../src/core/network_memcpy.h"
 #include "emac_counters.h"
 #include "firmware/debug/debug_dump.h"
+#include "emac/emac_rx.h"
 #include "emac/emac_debug.h"
 #include "gd32.h" // IWYU pragma: keep
 
@@ -56,6 +57,8 @@ extern uint32_t timestamp[2];
 } // namespace net::globals::ptp
 #endif
 
+/// Receive descriptors
+extern enet_descriptors_struct rxdesc_tab[ENET_RXBUF_NUM];
 /// Current receive descriptor
 extern enet_descriptors_struct* dma_current_rxdesc;
 /// Current transmit descriptor
@@ -76,13 +79,67 @@ uint32_t Recv(uint8_t** packet) {
 #else
         *packet = reinterpret_cast<uint8_t*>(dma_current_rxdesc->buffer1_addr);
 #endif
-        emac::eth::globals::counter.received++;
         return kLength;
     }
 
     return 0;
 }
 
+// True when at most one receive descriptor is still owned by the DMA.
+bool RecvIsFull() {
+    auto index = static_cast<uint32_t>(dma_current_rxdesc - rxdesc_tab);
+
+    for (uint32_t i = 0; i < (ENET_RXBUF_NUM - 1); i++) {
+        if (0 != (rxdesc_tab[index].status & ENET_RDES0_DAV)) {
+            return false;
+        }
+        index = (index + 1) % ENET_RXBUF_NUM;
+    }
+
+    return true;
+}
+
+// The received frame n positions behind the current one, 0 when there is none (yet).
+uint32_t RecvPeek(uint32_t n, uint8_t** packet) {
+    if (n >= ENET_RXBUF_NUM) {
+        return 0;
+    }
+
+    auto* desc = dma_current_rxdesc;
+#if defined(CONFIG_NET_ENABLE_PTP)
+    auto* ptp_desc = dma_current_ptp_rxdesc;
+#endif
+
+    for (uint32_t i = 0; i < n; i++) {
+        if (0 != (desc->status & ENET_RDES0_DAV)) {
+            return 0;
+        }
+#if defined(CONFIG_NET_ENABLE_PTP)
+        // A received descriptor holds the time stamp, the chain is kept in the PTP descriptor
+        desc = reinterpret_cast<enet_descriptors_struct*>(ptp_desc->buffer2_next_desc_addr);
+        ptp_desc = (0 != ptp_desc->status) ? reinterpret_cast<enet_descriptors_struct*>(ptp_desc->status) : (ptp_desc + 1);
+#else
+        desc = reinterpret_cast<enet_descriptors_struct*>(desc->buffer2_next_desc_addr);
+#endif
+    }
+
+    if (0 != (desc->status & ENET_RDES0_DAV)) {
+        return 0;
+    }
+
+    const auto kLength = gd32::enet::DescInformationGet<RXDESC_FRAME_LENGTH>(desc);
+
+    if (kLength > 0) {
+#if defined(CONFIG_NET_ENABLE_PTP)
+        *packet = reinterpret_cast<uint8_t*>(ptp_desc->buffer1_addr);
+#else
+        *packet = reinterpret_cast<uint8_t*>(desc->buffer1_addr);
+#endif
+    }
+
+    return kLength;
+}
+
 #if defined(CONFIG_NET_ENABLE_PTP)
 // Handles reception of a PTP frame in normal mode.
 static void PtpFrameReceiveNormalMode() {
@@ -132,10 +189,18 @@ static void FrameReceive() {
  * @brief Frees the current packet from the DMA buffer.
  */
 void FreePkt() {
+    if (emac::rx::IsQueuedFrame()) [[unlikely]] {
+        emac::rx::FreeQueuedFrame();
+        return;
+    }
+
     while (0 != (dma_current_rxdesc->status & ENET_RDES0_DAV)) {
         __DMB();
     }
 
+    // Counted here, a frame left in the ring is returned by Recv more than once
+    emac::eth::globals::counter.received++;
+
 #if defined(CONFIG_NET_ENABLE_PTP)
     PtpFrameReceiveNormalMode();
 #else
@@ -27,6 +27,7 @@
 #include <cstddef>
 
 #include "gd32_enet.h"
+#include "core/ip4/igmp.h"
 #include "emac/emac_debug.h"
 #include "gd32.h" // IWYU pragma: keep
 
@@ -35,21 +36,25 @@ uint32_t Crc(const uint8_t* data, size_t length);
 }
 
 namespace emac::multicast {
+static constexpr enet_macaddress_enum kPerfectAddress[kPerfectSlots] = {ENET_MAC_ADDRESS1, ENET_MAC_ADDRESS2, ENET_MAC_ADDRESS3};
 
 void EnableHashFilter() {
     EMAC_IGMP_DEBUG_ENTRY();
 
     gd32::enet::ResetHash();
+    ResetPerfect();
     gd32::enet::FilterFeatureDisable<ENET_MULTICAST_FILTER_PASS>();
-    gd32::enet::FilterFeatureEnable<ENET_MULTICAST_FILTER_HASH_MODE>();
+    // A multicast frame passes on a perfect match or a hash match
+    gd32::enet::FilterFeatureEnable<ENET_MULTICAST_FILTER_HASH_OR_PERFECT>();
 
     EMAC_IGMP_DEBUG_EXIT();
 }
 void DisableHashFilter() {
     EMAC_IGMP_DEBUG_ENTRY();
 
-    gd32::enet::FilterFeatureDisable<ENET_MULTICAST_FILTER_HASH_MODE>();
+    gd32::enet::FilterFeatureDisable<ENET_MULTICAST_FILTER_HASH_OR_PERFECT>();
     gd32::enet::FilterFeatureEnable<ENET_MULTICAST_FILTER_PASS>();
+    ResetPerfect();
 
     EMAC_IGMP_DEBUG_EXIT();
 }
@@ -66,6 +71,30 @@ void SetHash(const uint8_t* mac_addr) {
     EMAC_IGMP_DEBUG_EXIT();
 }
 
+void SetPerfect(uint32_t slot, const uint8_t* mac_addr) {
+    EMAC_IGMP_DEBUG_ENTRY();
+
+    if (slot >= kPerfectSlots) {
+        EMAC_IGMP_DEBUG_EXIT();
+        return;
+    }
+
+    gd32::enet::FilterSetPerfect(kPerfectAddress[slot], mac_addr);
+
+    EMAC_IGMP_DEBUG_PRINTF("Slot %u: " MACSTR, static_cast<unsigned>(slot), MAC2STR(mac_addr));
+    EMAC_IGMP_DEBUG_EXIT();
+}
+
+void ResetPerfect() {
+    EMAC_IGMP_DEBUG_ENTRY();
+
+    for (uint32_t slot = 0; slot < kPerfectSlots; slot++) {
+        gd32::enet::FilterResetPerfect(kPerfectAddress[slot]);
+    }
+
+    EMAC_IGMP_DEBUG_EXIT();
+}
+
 void ResetHash() {
     EMAC_IGMP_DEBUG_ENTRY();
 
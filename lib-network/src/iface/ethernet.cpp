@@ -49,6 +49,12 @@ __attribute__((weak)) void Input([[maybe_unused]] const uint8_t*, [[maybe_unused
 } // namespace ptp
 
 namespace iface {
+static uint32_t s_multicast_dropped;
+
+uint32_t MulticastDropped() {
+    return s_multicast_dropped;
+}
+
 void EthernetInput(const uint8_t* buffer, [[maybe_unused]] uint32_t length) {
     const auto* const kEther = reinterpret_cast<const struct network::ethernet::Header*>(buffer);
 
@@ -64,7 +70,9 @@ void EthernetInput(const uint8_t* buffer, [[maybe_unused]] uint32_t length) {
             NETWORK_IFACE_DEBUG_PRINTF(IPSTR " " IPSTR, kIp4->ip4.dst[0], kIp4->ip4.dst[1], kIp4->ip4.dst[2], kIp4->ip4.dst[3], kIp4->ip4.src[0], kIp4->ip4.src[1], kIp4->ip4.src[2], kIp4->ip4.src[3]);
 
             if ((kEther->dst[0] == network::ethernet::kIP4MulticastAddr0) && (kEther->dst[1] == network::ethernet::kIP4MulticastAddr1) && (kEther->dst[2] == network::ethernet::kIP4MulticastAddr2)) {
+                // The hash filter lets through groups sharing a hash bucket
                 if (!network::igmp::LookupGroup(network::MemcpyIp(kIp4->ip4.dst))) {
+                    s_multicast_dropped++;
                     emac::eth::FreePkt();
                     DEBUG_PUTS("IGMP not for us");
                     return;
@@ -26,55 +26,41 @@
 #include <cstdint>
 
 #include "network_iface.h"
+#if !defined(NO_EMAC) && !defined(ESP8266)
+#include "emac/emac_rx.h"
+#endif
+#include "json/json_writer.h"
 
 namespace json::status::emac {
-static uint32_t U32ToDec(char* dst, uint32_t v) {
-    // Write digits into a temp buffer in reverse order
-    char tmp[12]; // enough for 2^32-1 = 4.294.967.294
-    uint32_t i = 0;
-    do {
-        const auto kQ = v / 10U;
-        const auto kR = v - (kQ * 10U);
-        tmp[i++] = static_cast<char>('0' + kR);
-        v = kQ;
-    } while (v > 0);
-
-    for (uint32_t j = 0; j < i; ++j) {
-        dst[j] = tmp[i - 1 - j];
-    }
-    return i;
-}
-
-uint32_t Emac(char* out_buffer, uint32_t out_buffer_size) {
+void Emac(Writer& writer) {
     network::iface::Counters counters;
     network::iface::GetCounters(counters);
 
-    auto* p = out_buffer;
-    auto* end = out_buffer + out_buffer_size;
-
-    auto write_string = [&](const char* s) {
-        while (*s && p < end) *p++ = *s++;
-    };
-    auto write_u32 = [&](uint32_t v) { p += U32ToDec(p, v); };
-
-    write_string("{\"rx_ok\":");
-    write_u32(counters.rx.ok);
-    write_string(",\"rx_err\":");
-    write_u32(counters.rx.err);
-    write_string(",\"rx_drp\":");
-    write_u32(counters.rx.drp);
-    write_string(",\"rx_ovr\":");
-    write_u32(counters.rx.ovr);
-    write_string(",\"tx_ok\":");
-    write_u32(counters.tx.ok);
-    write_string(",\"tx_err\":");
-    write_u32(counters.tx.err);
-    write_string(",\"tx_drp\":");
-    write_u32(counters.tx.drp);
-    write_string(",\"tx_ovr\":");
-    write_u32(counters.tx.ovr);
-    write_string("}");
-
-    return static_cast<uint32_t>(p - out_buffer);
+    writer.ObjectBegin();
+    writer.Field("rx_ok", counters.rx.ok);
+    writer.Field("rx_err", counters.rx.err);
+    writer.Field("rx_drp", counters.rx.drp);
+    writer.Field("rx_ovr", counters.rx.ovr);
+    writer.Field("rx_mc_drp", counters.rx.mc_drp);
+    writer.Field("tx_ok", counters.tx.ok);
+    writer.Field("tx_err", counters.tx.err);
+    writer.Field("tx_drp", counters.tx.drp);
+    writer.Field("tx_ovr", counters.tx.ovr);
+#if !defined(NO_EMAC) && !defined(ESP8266)
+    writer.ArrayBegin("rx_class");
+    for (uint32_t i = 0; i < ::emac::rx::kClasses; i++) {
+        const auto kClass = static_cast<::emac::rx::Class>(i);
+        const auto& kCounters = ::emac::rx::GetCounters(kClass);
+        writer.ObjectBegin();
+        writer.Field("class", ::emac::rx::GetClassName(kClass));
+        writer.Field("rx", kCounters.received);
+        writer.Field("deferred", kCounters.deferred);
+        writer.Field("forced", kCounters.forced);
+        writer.Field("latency_max_us", kCounters.latency_max_us);
+        writer.ObjectEnd();
+    }
+    writer.ArrayEnd();
+#endif
+    writer.ObjectEnd();
 }
 } // namespace json::status::emac
@@ -23,22 +23,19 @@
  * THE SOFTWARE.
  */
 
-#include <cstdio>
-
 #include "emac/emac_phy.h"
+#include "json/json_writer.h"
 
 namespace json::status::emac {
-uint32_t Phy(char* out_buffer, uint32_t out_buffer_size) {
+void Phy(Writer& writer) {
     ::emac::phy::Status phy_status;
     ::emac::phy::CustomizedStatus(phy_status);
 
-    const auto kLength = static_cast<uint32_t>(snprintf(out_buffer, out_buffer_size, 
-		"{\"link\":\"%s\",\"speed\":\"%s\",\"duplex\":\"%s\",\"autonegotiation\":\"%s\"}", 
-		::emac::phy::ToString(phy_status.link),
-		::emac::phy::ToString(phy_status.speed), 
-		::emac::phy::ToString(phy_status.duplex), 
-		::emac::phy::ToStringAutonegotiation(phy_status.autonegotiation)));
-
-    return kLength;
+    writer.ObjectBegin();
+    writer.Field("link", ::emac::phy::ToString(phy_status.link));
+    writer.Field("speed", ::emac::phy::ToString(phy_status.speed));
+    writer.Field("duplex", ::emac::phy::ToString(phy_status.duplex));
+    writer.Field("autonegotiation", ::emac::phy::ToStringAutonegotiation(phy_status.autonegotiation));
+    writer.ObjectEnd();
 }
 } // namespace json::status::emac
@@ -0,0 +1,137 @@
+/**
+ * @file gamma16.h
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef GAMMA_GAMMA16_H_
+#define GAMMA_GAMMA16_H_
+
+#include <cstdint>
+
+/*
+ * 16-bit gamma tables, 257 entries: entry i is (i / 256) ^ gamma.
+ * A 16-bit input is looked up with its high byte and linearly
+ * interpolated with its low byte.
+ *
+ * The tables are computed at compile time, no libm is needed.
+ */
+namespace gamma16 {
+inline constexpr uint32_t kSize = 257;
+
+struct Table {
+    uint16_t value[kSize];
+};
+
+namespace detail {
+consteval double Exp(double x) {
+    uint32_t halvings = 0;
+
+    while (x < -0.5) {
+        x /= 2.0;
+        halvings++;
+    }
+
+    double sum = 1.0;
+    double term = 1.0;
+
+    for (uint32_t n = 1; n < 24; n++) {
+        term *= x / n;
+        sum += term;
+    }
+
+    while (halvings-- != 0) {
+        sum *= sum;
+    }
+
+    return sum;
+}
+
+// x in (0, 1]
+consteval double Log(double x) {
+    constexpr double kLn2 = 0.69314718055994530942;
+    double result = 0.0;
+
+    while (x < 0.5) {
+        x *= 2.0;
+        result -= kLn2;
+    }
+
+    // ln(x) = 2 * atanh((x - 1) / (x + 1))
+    const auto kY = (x - 1.0) / (x + 1.0);
+    const auto kY2 = kY * kY;
+    double term = kY;
+
+    for (uint32_t n = 1; n < 40; n += 2) {
+        result += 2.0 * term / n;
+        term *= kY2;
+    }
+
+    return result;
+}
+
+consteval Table Make(uint32_t value) {
+    Table table{};
+
+    for (uint32_t i = 1; i < kSize; i++) {
+        const auto kX = static_cast<double>(i) / 256.0;
+        const auto kY = Exp((static_cast<double>(value) / 10.0) * Log(kX));
+        const auto kV = static_cast<uint32_t>(kY * 65535.0 + 0.5);
+        table.value[i] = static_cast<uint16_t>(kV > 65535 ? 65535 : kV);
+    }
+
+    return table;
+}
+} // namespace detail
+
+inline constexpr Table kGamma10 = detail::Make(10);
+inline constexpr Table kGamma20 = detail::Make(20);
+inline constexpr Table kGamma21 = detail::Make(21);
+inline constexpr Table kGamma22 = detail::Make(22);
+inline constexpr Table kGamma23 = detail::Make(23);
+inline constexpr Table kGamma24 = detail::Make(24);
+inline constexpr Table kGamma25 = detail::Make(25);
+
+/**
+ * @param value gamma * 10, as returned by gamma::GetValue
+ */
+inline const uint16_t* GetTable(uint32_t value) {
+    switch (value) {
+        case 20:
+            return kGamma20.value;
+        case 21:
+            return kGamma21.value;
+        case 22:
+            return kGamma22.value;
+        case 23:
+            return kGamma23.value;
+        case 24:
+            return kGamma24.value;
+        case 25:
+            return kGamma25.value;
+        default:
+            return kGamma10.value;
+    }
+}
+} // namespace gamma16
+
+#endif // GAMMA_GAMMA16_H_
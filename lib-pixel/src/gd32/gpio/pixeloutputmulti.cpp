@@ -32,6 +32,7 @@
 #include "gd32_gpio.h"
 #include "gd32_dma.h"
 #include "gd32_dma_memcpy32.h"
+#include "firmware/debug/debug_profile.h"
 #include "pixel_debug.h"
 
 #if defined(GD32F20X) || defined(GD32F4XX)
@@ -632,6 +633,7 @@ void PixelOutputMulti::FullOn() {
 #pragma GCC optimize("O3")
 
 void PixelOutputMulti::Update() {
+    DEBUG_PROFILE_SCOPE(kPixelUpdate);
     do { // https://github.com/vanvught/rpidmx512/issues/281
         __ISB();
     } while (sv_is_running);
@@ -24,7 +24,6 @@
 */
 
 #include <cstdint>
-#include <cstdio>
 
 #if defined(OUTPUT_DMX_PIXEL)
 #include "pixeloutput.h"
@@ -35,16 +34,16 @@
 #if defined(OUTPUT_DMX_PIXEL) || defined(OUTPUT_DMX_PIXEL_MULTI)
 #include "pixelconfiguration.h"
 
+#include "json/json_writer.h"
+
 namespace json::status {
-uint32_t Pixel(char* out_buffer, uint32_t out_buffer_size) {
+void Pixel(Writer& writer) {
     auto& configuration = PixelConfiguration::Get();
-    const auto kUserData = PixelOutputType::Get()->GetUserData();
 
-    return static_cast<uint32_t>(snprintf(out_buffer, out_buffer_size, 
-		"{\"refresh_rate\":\"%u\",\"frame_rate\":\"%u\"}", 
-		static_cast<unsigned>(configuration.GetRefreshRate()), 
-		static_cast<unsigned>(kUserData))
-	);
+    writer.ObjectBegin();
+    writer.FieldQuoted("refresh_rate", configuration.GetRefreshRate());
+    writer.FieldQuoted("frame_rate", PixelOutputType::Get()->GetUserData());
+    writer.ObjectEnd();
 }
 } // namespace json::status
-#endif
\ No newline at end of file
+#endif
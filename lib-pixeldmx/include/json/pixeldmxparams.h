@@ -75,6 +75,10 @@ class PixelDmxParams : public JsonParamsBase<PixelDmxParams>
     static void SetGammaCorrection(const char* val, uint32_t len);
     static void SetGammaValue(const char* val, uint32_t len);
 #endif
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+    static void SetInput16Bit(const char* val, uint32_t len);
+    static void SetDithering(const char* val, uint32_t len);
+#endif
 
     static constexpr json::Key kPixelDmxKeys[] = {
 	MakeKey(SetType, DmxLedParamsConst::kType), 
@@ -114,8 +118,12 @@ class PixelDmxParams : public JsonParamsBase<PixelDmxParams>
 #endif
 #if defined(CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
    MakeKey(SetGammaCorrection, DmxLedParamsConst::kGammaCorrection),
-   MakeKey(SetGammaValue, DmxLedParamsConst::kGammaValue)
+   MakeKey(SetGammaValue, DmxLedParamsConst::kGammaValue),
 #endif   
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+	MakeKey(SetInput16Bit, PixelDmxParamsConst::kInput16Bit),
+	MakeKey(SetDithering, PixelDmxParamsConst::kDithering),
+#endif
     };
 
     inline static common::store::DmxLed store_dmxled;
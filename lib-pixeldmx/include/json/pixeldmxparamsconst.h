@@ -34,6 +34,8 @@ struct PixelDmxParamsConst {
     static constexpr auto kDmxStartAddress = json::MakeSimpleKey("dmx_start_address");
 
     static constexpr auto kDmxSlotInfo = json::MakeSimpleKey("dmx_slot_info");
+    static constexpr auto kInput16Bit = json::MakeSimpleKey("input_16bit");
+    static constexpr auto kDithering = json::MakeSimpleKey("dithering");
     static constexpr json::PortKey kStartUniPort1{"start_uni_port_1", 16, Fnv1a32("start_uni_port_1", 16)};
 #if (CONFIG_DMXNODE_PIXEL_MAX_PORTS > 1)
     static constexpr json::PortKey kStartUniPort2{"start_uni_port_2", 16, Fnv1a32("start_uni_port_2", 16)};
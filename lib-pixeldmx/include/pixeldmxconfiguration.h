@@ -87,6 +87,25 @@ class PixelDmxConfiguration : public PixelConfiguration {
 
     uint16_t GetDmxFootprint() const { return dmx_footprint_; }
 
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+    /**
+     * 2 DMX slots per colour, most significant byte first
+     */
+    void SetInput16Bit(bool is_input_16bit) { is_input_16bit_ = is_input_16bit; }
+    bool IsInput16Bit() const { return is_input_16bit_; }
+
+    /**
+     * Temporal dithering of the 16-bit input to the 8-bit output, off by default.
+     * It advances once per received frame, see pixeldmxmulti::kDither.
+     */
+    void SetDithering(bool is_dithering) { is_dithering_ = is_dithering; }
+    bool IsDithering() const { return is_dithering_; }
+
+    uint32_t GetSlotsPerPixel() const { return PixelConfiguration::GetLedsPerPixel() * (is_input_16bit_ ? 2U : 1U); }
+#else
+    uint32_t GetSlotsPerPixel() const { return PixelConfiguration::GetLedsPerPixel(); }
+#endif
+
     void Validate(uint32_t ports_max) {
         DEBUG_ENTRY();
 
@@ -100,16 +119,18 @@ class PixelDmxConfiguration : public PixelConfiguration {
             PixelConfiguration::Validate();
         }
 
-        port_info_.begin_index_port[0] = 0;
+        // Pixels per universe
+        const auto kPixels = dmxnode::kUniverseSize / GetSlotsPerPixel();
 
-        if (PixelConfiguration::GetType() == pixel::LedType::kSK6812W) {
-            port_info_.begin_index_port[1] = 128;
-            port_info_.begin_index_port[2] = 256;
-            port_info_.begin_index_port[3] = 384;
-        } else {
-            port_info_.begin_index_port[1] = 170;
-            port_info_.begin_index_port[2] = 340;
-            port_info_.begin_index_port[3] = 510;
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+        // An output has 4 universes (begin_index_port), 16-bit input halves the pixels per universe
+        if (PixelConfiguration::GetCount() > (4U * kPixels)) {
+            PixelConfiguration::SetCount(4U * kPixels);
+        }
+#endif
+
+        for (uint32_t i = 0; i < 4; i++) {
+            port_info_.begin_index_port[i] = static_cast<uint16_t>(i * kPixels);
         }
 
         if ((grouping_count_ == 0) || (grouping_count_ > PixelConfiguration::GetCount())) {
@@ -119,7 +140,7 @@ class PixelDmxConfiguration : public PixelConfiguration {
         groups_ = PixelConfiguration::GetCount() / grouping_count_;
         output_ports_ = std::min(ports_max, output_ports_);
         universes_ = (1U + (groups_ / (1U + port_info_.begin_index_port[1])));
-        dmx_footprint_ = static_cast<uint16_t>(PixelConfiguration::GetLedsPerPixel() * groups_);
+        dmx_footprint_ = static_cast<uint16_t>(GetSlotsPerPixel() * groups_);
         
 		if (dmx_start_address_ == 0) {
             dmx_start_address_ = dmxnode::kStartAddressDefault;
@@ -145,6 +166,9 @@ class PixelDmxConfiguration : public PixelConfiguration {
         printf(" Grouping count : %u [Groups : %u]\n", static_cast<unsigned>(grouping_count_), static_cast<unsigned>(groups_));
         printf(" Universes      : %u\n", static_cast<unsigned>(universes_));
         printf(" DmxFootprint   : %u\n", static_cast<unsigned>(dmx_footprint_));
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+        printf(" Input          : %u bit%s\n", is_input_16bit_ ? 16U : 8U, (is_input_16bit_ && is_dithering_) ? ", dithering" : "");
+#endif
 
 #ifndef NDEBUG
         const auto& begin_index_port = port_info_.begin_index_port;
@@ -170,6 +194,10 @@ class PixelDmxConfiguration : public PixelConfiguration {
     uint16_t dmx_start_address_{1};
     uint16_t dmx_footprint_{0};
     pixeldmxconfiguration::PortInfo port_info_;
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+    bool is_input_16bit_{false};
+    bool is_dithering_{false};
+#endif
 
     static inline PixelDmxConfiguration* s_this;
 };
@@ -43,6 +43,9 @@
 #include "dmxnodedata.h"
 #include "pixeloutputmulti.h"
 #include "pixeldmxconfiguration.h"
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+#include "gamma/gamma16.h"
+#endif
 #include "logic_analyzer.h"
 #if defined(PIXELDMXSTARTSTOP_GPIO)
 #include "gpio.h"
@@ -54,6 +57,24 @@ namespace pixeldmxmulti {
 #error
 #endif
 static constexpr auto kMaxPorts = CONFIG_DMXNODE_PIXEL_MAX_PORTS;
+
+/*
+ * Selects the pixel loop at ApplyConfiguration, so the loop itself has no
+ * per pixel branches on protocol, channel count or led type.
+ */
+enum class Output { kRtz3, kRtz4, kWS2801, kAPA102, kP9813 };
+enum class Input { k8Bit, k16Bit, k16BitDither };
+
+/*
+ * Ordered temporal dither thresholds. The frame counter plus the pixel index
+ * selects one, so neighbouring pixels do not toggle in the same frame.
+ *
+ * The frame counter only advances with a received frame, the output is not
+ * refreshed on its own. At 40 fps the 16 steps repeat at 2.5 Hz, which can
+ * show as flicker on dark levels. Dithering is therefore off by default and
+ * only useful with a high input frame rate.
+ */
+inline constexpr uint8_t kDither[16] = {0, 128, 64, 192, 32, 160, 96, 224, 16, 144, 80, 208, 48, 176, 112, 240};
 } // namespace pixeldmxmulti
 
 class PixelDmxMulti final : public PixelDmxConfiguration {
@@ -92,6 +113,39 @@ class PixelDmxMulti final : public PixelDmxConfiguration {
 
         output_type_.ApplyConfiguration();
         output_type_.Blackout();
+
+        // APA102/SK9822 have their global brightness in the led frame
+        const auto kType = PixelDmxConfiguration::GetType();
+        brightness_ = ((kType == pixel::LedType::kAPA102) || (kType == pixel::LedType::kSK9822)) ? 0xFF : PixelDmxConfiguration::GetGlobalBrightness();
+
+        BuildTransform();
+    }
+
+    /**
+     * Software brightness, folded into the channel lookup table.
+     */
+    void SetBrightness(uint8_t brightness) {
+        if (brightness == brightness_) {
+            return;
+        }
+
+        brightness_ = brightness;
+        BuildTransform();
+    }
+
+    uint8_t GetBrightness() const { return brightness_; }
+
+    /**
+     * A whole strip in one call, for the protocols that are not universe based.
+     * The update is done with Sync.
+     */
+    void SetStrip(uint32_t out_index, const uint8_t* data, uint32_t length) {
+        assert(out_index < pixeldmxmulti::kMaxPorts);
+        assert(data != nullptr);
+
+        const auto kEndIndex = std::min(PixelDmxConfiguration::GetGroups(), length / PixelDmxConfiguration::GetSlotsPerPixel());
+
+        (this->*set_pixels_)(out_index, 0, kEndIndex, data, length);
     }
 
     void Start(uint32_t port_index) {
@@ -151,6 +205,9 @@ class PixelDmxMulti final : public PixelDmxConfiguration {
                 }
 
                 output_type_.Update();
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+                frame_++;
+#endif
 
                 logic_analyzer::Ch1Clear();
             }
@@ -175,6 +232,9 @@ class PixelDmxMulti final : public PixelDmxConfiguration {
         logic_analyzer::Ch1Set();
 
         output_type_.Update();
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+        frame_++;
+#endif
 
         need_sync_ = false;
 
@@ -249,99 +309,170 @@ class PixelDmxMulti final : public PixelDmxConfiguration {
 
         const auto kGroups = PixelDmxConfiguration::GetGroups();
         const auto kBeginIndex = port_info.begin_index_port[kSwitch];
-        const auto kChannelsPerPixel = PixelDmxConfiguration::GetLedsPerPixel();
-        const auto kEndIndex = std::min(kGroups, (kBeginIndex + (length / kChannelsPerPixel)));
-        const auto kGroupingCount = PixelDmxConfiguration::GetGroupingCount();
-        const auto kPixelType = PixelDmxConfiguration::GetType();
-        const auto kIsRtzProtocol = PixelDmxConfiguration::IsRTZProtocol();
+        const auto kSlotsPerPixel = PixelDmxConfiguration::GetSlotsPerPixel();
+        const auto kEndIndex = std::min(kGroups, (kBeginIndex + (length / kSlotsPerPixel)));
 
-        uint32_t d = 0;
+        (this->*set_pixels_)(kOutIndex, kBeginIndex, kEndIndex, data, length);
+    }
 
-        if (kChannelsPerPixel == 3) {
-            // Define a lambda to handle pixel setting based on color order
-            auto set_pixels_colour_rtz = [&](uint32_t portindex, uint32_t pixelindex, uint8_t r, uint8_t g, uint8_t b) {
+    /*
+     * Gamma and brightness in one table, rebuilt only when the configuration changes.
+     */
+    void BuildTransform() {
 #if defined(CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
-                const auto kGammaTable = PixelDmxConfiguration::GetGammaTable();
-                r = kGammaTable[r];
-                g = kGammaTable[g];
-                b = kGammaTable[b];
+        const auto* const kGammaTable = PixelDmxConfiguration::GetGammaTable();
 #endif
-                output_type_.SetColourRTZ(portindex, pixelindex, r, g, b);
-            };
+        for (uint32_t i = 0; i < sizeof(lut_); i++) {
+#if defined(CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
+            const uint32_t kValue = kGammaTable[i];
+#else
+            const uint32_t kValue = i;
+#endif
+            lut_[i] = static_cast<uint8_t>(((kValue * brightness_) + 127U) / 255U);
+        }
 
-            // Define a lambda to handle pixel setting based on color order
-            auto set_pixels_colour3 = [&](uint32_t portindex, uint32_t pixelindex, uint8_t r, uint8_t g, uint8_t b) {
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
 #if defined(CONFIG_PIXELDMX_ENABLE_GAMMATABLE)
-                const auto kGammaTable = PixelDmxConfiguration::GetGammaTable();
-                r = kGammaTable[r];
-                g = kGammaTable[g];
-                b = kGammaTable[b];
+        const auto* const kGammaTable16 = gamma16::GetTable(PixelDmxConfiguration::GetGammaTableValue());
+#else
+        const auto* const kGammaTable16 = gamma16::GetTable(10);
+#endif
+        for (uint32_t i = 0; i < gamma16::kSize; i++) {
+            lut16_[i] = static_cast<uint16_t>(((kGammaTable16[i] * static_cast<uint32_t>(brightness_)) + 127U) / 255U);
+        }
 #endif
 
-                switch (kPixelType) {
-                    case pixel::LedType::kWS2801:
-                        output_type_.SetColourWS2801(portindex, pixelindex, r, g, b);
-                        break;
-                    case pixel::LedType::kAPA102:
-                    case pixel::LedType::kSK9822:
-                        output_type_.SetPixel4Bytes(portindex, 1 + pixelindex, PixelDmxConfiguration::GetGlobalBrightness(), b, g, r);
-                        break;
-                    case pixel::LedType::kP9813: {
-                        const auto kFlag = static_cast<uint8_t>(0xC0 | ((~b & 0xC0) >> 2) | ((~r & 0xC0) >> 4) | ((~r & 0xC0) >> 6));
-                        output_type_.SetPixel4Bytes(portindex, 1 + pixelindex, kFlag, b, g, r);
-                    } break;
-                    default:
-                        assert(0);
-                        __builtin_unreachable();
-                        break;
-                }
-            };
-
-            constexpr uint32_t kChannelMap[6][3] = {
-                {0, 1, 2}, // RGB
-                {0, 2, 1}, // RBG
-                {1, 0, 2}, // GRB
-                {2, 0, 1}, // GBR
-                {1, 2, 0}, // BRG
-                {2, 1, 0}  // BGR
-            };
-
-            const auto kMapIndex = static_cast<uint32_t>(PixelDmxConfiguration::GetMap());
-            // Ensure mapIndex is within valid bounds
-            assert(kMapIndex < sizeof(kChannelMap) / sizeof(kChannelMap[0])); // Runtime check
-            auto const& map = kChannelMap[kMapIndex];
-
-            if (kIsRtzProtocol) {
-                for (uint32_t j = kBeginIndex; (j < kEndIndex) && (d < length); j++) {
-                    auto const kPixelIndexStart = j * kGroupingCount;
-                    for (uint32_t k = 0; k < kGroupingCount; k++) {
-                        set_pixels_colour_rtz(kOutIndex, kPixelIndexStart + k, data[d + map[0]], data[d + map[1]], data[d + map[2]]);
-                    }
-                    d += 3; // Increment by 3 since we're processing 3 channels per pixel
-                }
+        constexpr uint8_t kChannelMap[6][3] = {
+            {0, 1, 2}, // RGB
+            {0, 2, 1}, // RBG
+            {1, 0, 2}, // GRB
+            {2, 0, 1}, // GBR
+            {1, 2, 0}, // BRG
+            {2, 1, 0}  // BGR
+        };
+
+        // RGBW pixels are not remapped
+        const auto kMapIndex = (PixelDmxConfiguration::GetLedsPerPixel() == 3) ? static_cast<uint32_t>(PixelDmxConfiguration::GetMap()) : 0;
+        assert(kMapIndex < sizeof(kChannelMap) / sizeof(kChannelMap[0]));
+
+        for (uint32_t i = 0; i < 3; i++) {
+            map_[i] = kChannelMap[kMapIndex][i];
+        }
+
+        if (PixelDmxConfiguration::IsRTZProtocol()) {
+            if (PixelDmxConfiguration::GetLedsPerPixel() == 4) {
+                SelectInput<pixeldmxmulti::Output::kRtz4>();
             } else {
-                for (uint32_t j = kBeginIndex; (j < kEndIndex) && (d < length); j++) {
-                    auto const kPixelIndexStart = j * kGroupingCount;
-                    for (uint32_t k = 0; k < kGroupingCount; k++) {
-                        set_pixels_colour3(kOutIndex, kPixelIndexStart + k, data[d + map[0]], data[d + map[1]], data[d + map[2]]);
-                    }
-                    d += 3; // Increment by 3 since we're processing 3 channels per pixel
-                }
+                SelectInput<pixeldmxmulti::Output::kRtz3>();
             }
-        } else {
-            assert(kChannelsPerPixel == 4);
-            assert(kIsRtzProtocol);
-            for (uint32_t j = kBeginIndex; (j < kEndIndex) && (d < length); j++) {
-                auto const kPixelIndexStart = (j * kGroupingCount);
-                for (uint32_t k = 0; k < kGroupingCount; k++) {
-                    output_type_.SetColourRTZ(kOutIndex, kPixelIndexStart + k, data[d], data[d + 1], data[d + 2], data[d + 3]);
+            return;
+        }
+
+        switch (PixelDmxConfiguration::GetType()) {
+            case pixel::LedType::kAPA102:
+            case pixel::LedType::kSK9822:
+                SelectInput<pixeldmxmulti::Output::kAPA102>();
+                break;
+            case pixel::LedType::kP9813:
+                SelectInput<pixeldmxmulti::Output::kP9813>();
+                break;
+            default:
+                SelectInput<pixeldmxmulti::Output::kWS2801>();
+                break;
+        }
+    }
+
+    template <pixeldmxmulti::Output kOutput>
+    void SelectInput() {
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+        if (PixelDmxConfiguration::IsInput16Bit()) {
+            if (PixelDmxConfiguration::IsDithering()) {
+                set_pixels_ = &PixelDmxMulti::SetPixels<kOutput, pixeldmxmulti::Input::k16BitDither>;
+            } else {
+                set_pixels_ = &PixelDmxMulti::SetPixels<kOutput, pixeldmxmulti::Input::k16Bit>;
+            }
+            return;
+        }
+#endif
+        set_pixels_ = &PixelDmxMulti::SetPixels<kOutput, pixeldmxmulti::Input::k8Bit>;
+    }
+
+    /*
+     * 16-bit: the high byte selects the table entry, the low byte interpolates.
+     * The threshold rounds (128) or dithers the result to 8 bits.
+     */
+    template <pixeldmxmulti::Input kInput>
+    uint8_t Colour(const uint8_t* slot, [[maybe_unused]] uint32_t threshold) const {
+        if constexpr (kInput == pixeldmxmulti::Input::k8Bit) {
+            return lut_[slot[0]];
+        }
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+        else {
+            const uint32_t kLow = lut16_[slot[0]];
+            const uint32_t kHigh = lut16_[slot[0] + 1U];
+            const auto kValue = (kLow + (((kHigh - kLow) * slot[1]) >> 8) + threshold) >> 8;
+            return static_cast<uint8_t>(kValue > 0xFF ? 0xFF : kValue);
+        }
+#endif
+    }
+
+    template <pixeldmxmulti::Output kOutput, pixeldmxmulti::Input kInput>
+    void SetPixels(uint32_t out_index, uint32_t begin_index, uint32_t end_index, const uint8_t* data, uint32_t length) {
+        constexpr uint32_t kColours = (kOutput == pixeldmxmulti::Output::kRtz4) ? 4 : 3;
+        constexpr uint32_t kSlotsPerColour = (kInput == pixeldmxmulti::Input::k8Bit) ? 1 : 2;
+        constexpr uint32_t kSlotsPerPixel = kColours * kSlotsPerColour;
+        const auto kGroupingCount = PixelDmxConfiguration::GetGroupingCount();
+        const auto kMap0 = map_[0] * kSlotsPerColour;
+        const auto kMap1 = map_[1] * kSlotsPerColour;
+        const auto kMap2 = map_[2] * kSlotsPerColour;
+        [[maybe_unused]] const auto kGlobalBrightness = PixelDmxConfiguration::GetGlobalBrightness();
+
+        for (uint32_t j = begin_index, d = 0; (j < end_index) && (d < length); j++, d += kSlotsPerPixel) {
+            uint32_t threshold = 128;
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+            if constexpr (kInput == pixeldmxmulti::Input::k16BitDither) {
+                threshold = pixeldmxmulti::kDither[(frame_ + j) & 0xF];
+            }
+#endif
+            const auto kR = Colour<kInput>(&data[d + kMap0], threshold);
+            const auto kG = Colour<kInput>(&data[d + kMap1], threshold);
+            const auto kB = Colour<kInput>(&data[d + kMap2], threshold);
+            [[maybe_unused]] uint8_t white = 0;
+
+            if constexpr (kOutput == pixeldmxmulti::Output::kRtz4) {
+                white = Colour<kInput>(&data[d + 3 * kSlotsPerColour], threshold);
+            }
+
+            const auto kPixelIndexStart = j * kGroupingCount;
+
+            for (uint32_t k = 0; k < kGroupingCount; k++) {
+                if constexpr (kOutput == pixeldmxmulti::Output::kRtz4) {
+                    output_type_.SetColourRTZ(out_index, kPixelIndexStart + k, kR, kG, kB, white);
+                } else if constexpr (kOutput == pixeldmxmulti::Output::kRtz3) {
+                    output_type_.SetColourRTZ(out_index, kPixelIndexStart + k, kR, kG, kB);
+                } else if constexpr (kOutput == pixeldmxmulti::Output::kWS2801) {
+                    output_type_.SetColourWS2801(out_index, kPixelIndexStart + k, kR, kG, kB);
+                } else if constexpr (kOutput == pixeldmxmulti::Output::kAPA102) {
+                    output_type_.SetPixel4Bytes(out_index, 1 + kPixelIndexStart + k, kGlobalBrightness, kB, kG, kR);
+                } else {
+                    const auto kFlag = static_cast<uint8_t>(0xC0 | ((~kB & 0xC0) >> 2) | ((~kR & 0xC0) >> 4) | ((~kR & 0xC0) >> 6));
+                    output_type_.SetPixel4Bytes(out_index, 1 + kPixelIndexStart + k, kFlag, kB, kG, kR);
                 }
-                d = d + 4; // Increment by 4 since we're processing 4 channels per pixel
             }
         }
     }
 
+    using SetPixelsFunction = void (PixelDmxMulti::*)(uint32_t, uint32_t, uint32_t, const uint8_t*, uint32_t);
+
     PixelOutputType output_type_;
+    SetPixelsFunction set_pixels_{&PixelDmxMulti::SetPixels<pixeldmxmulti::Output::kRtz3, pixeldmxmulti::Input::k8Bit>};
+    uint8_t lut_[256];
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+    uint16_t lut16_[gamma16::kSize];
+    uint32_t frame_{0};
+#endif
+    uint8_t map_[3];
+    uint8_t brightness_{0xFF};
 
     uint32_t started_[2]; ///< Support for 16x4 = 64 ports.
     bool blackout_{false};
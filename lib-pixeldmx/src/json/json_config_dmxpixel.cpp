@@ -63,6 +63,10 @@ uint32_t GetPixelDmx(char* buffer, uint32_t length) {
 #if defined(OUTPUT_DMX_PIXEL_MULTI)
         doc[DmxLedParamsConst::kActiveOutputPorts.name] = pixel_dmx_configuration.GetOutputPorts();
 #endif
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+        doc[PixelDmxParamsConst::kInput16Bit.name] = static_cast<uint32_t>(pixel_dmx_configuration.IsInput16Bit());
+        doc[PixelDmxParamsConst::kDithering.name] = static_cast<uint32_t>(pixel_dmx_configuration.IsDithering());
+#endif
 #if defined(RDM_RESPONDER)
         doc[PixelDmxParamsConst::kDmxStartAddress.name] = pixel_dmx_configuration.GetDmxStartAddress();
 #endif
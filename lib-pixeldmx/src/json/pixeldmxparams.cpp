@@ -162,6 +162,20 @@ void PixelDmxParams::SetGammaValue(const char* val, uint32_t len) {
 }
 #endif
 
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+void PixelDmxParams::SetInput16Bit(const char* val, uint32_t len) {
+    if (len == 1) {
+        store_dmxled.flags = common::SetFlagValue(store_dmxled.flags, Flags::Flag::kInput16Bit, val[0] != '0');
+    }
+}
+
+void PixelDmxParams::SetDithering(const char* val, uint32_t len) {
+    if (len == 1) {
+        store_dmxled.flags = common::SetFlagValue(store_dmxled.flags, Flags::Flag::kDithering, val[0] != '0');
+    }
+}
+#endif
+
 void PixelDmxParams::Store(const char* buffer, uint32_t buffer_size) {
     ParseJsonWithTable(buffer, buffer_size, kPixelDmxKeys);
     ConfigStore::Instance().Store(&store_dmxled, &ConfigurationStore::dmx_led);
@@ -190,6 +204,10 @@ void PixelDmxParams::Set() {
 #if defined(OUTPUT_DMX_PIXEL_MULTI)
     pixel_dmx_configuration.SetOutputPorts(store_dmxled.active_outputs);
 #endif
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+    pixel_dmx_configuration.SetInput16Bit(common::IsFlagSet(store_dmxled.flags, Flags::Flag::kInput16Bit));
+    pixel_dmx_configuration.SetDithering(common::IsFlagSet(store_dmxled.flags, Flags::Flag::kDithering));
+#endif
 #if !defined(OUTPUT_DMX_PIXEL_MULTI)
     pixel_dmx_configuration.SetDmxStartAddress(store_dmxled.dmx_start_address);
 #endif
@@ -283,5 +301,9 @@ void PixelDmxParams::Dump() {
     printf(" %s=%d\n", DmxLedParamsConst::kGammaCorrection.name, common::IsFlagSet(store_dmxled.flags, Flags::Flag::kEnableGamma));
     printf(" %s=%1.1f [%u]\n", DmxLedParamsConst::kGammaValue.name, static_cast<float>(store_dmxled.gamma_value) / 10.0f, store_dmxled.gamma_value);
 #endif
+#if defined(CONFIG_PIXELDMX_ENABLE_16BIT)
+    printf(" %s=%d\n", PixelDmxParamsConst::kInput16Bit.name, common::IsFlagSet(store_dmxled.flags, Flags::Flag::kInput16Bit));
+    printf(" %s=%d\n", PixelDmxParamsConst::kDithering.name, common::IsFlagSet(store_dmxled.flags, Flags::Flag::kDithering));
+#endif
 }
 } // namespace json
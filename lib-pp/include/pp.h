@@ -57,6 +57,7 @@ namespace configuration
 static constexpr uint32_t CHANNELS_PER_PIXEL = 3;
 static constexpr uint32_t UNIVERSE_MAX_LENGTH = 510; ///< 512 / 3 {CHANNELS_PER_PIXEL} -> 170 * 3 {CHANNELS_PER_PIXEL} = 510
 static constexpr uint32_t COUNT_MAX = 480;           ///< 1440 / 3 {CHANNELS_PER_PIXEL}
+static constexpr uint32_t FRAME_TIMEOUT_MILLIS = 20; ///< An incomplete frame is shown when no more strips arrive
 } // namespace configuration
 static constexpr uint16_t UDP_PORT_DISCOVERY = 7331;
 static constexpr uint16_t UDP_PORT_DATA = 5078;
@@ -201,9 +202,7 @@ class PixelPusher
     void SetCount(uint32_t count, uint32_t active_ports, bool has_global_brightness)
     {
         count_ = std::min(count, pp::configuration::COUNT_MAX);
-        universes_ = 1 + (count_ / (1 + (pp::configuration::UNIVERSE_MAX_LENGTH / pp::configuration::CHANNELS_PER_PIXEL)));
         active_ports_ = std::min(active_ports, pp::lightset::MAX_PORTS / 3U);
-        port_index_last_ = active_ports_ * universes_;
         has_global_brightness_ = has_global_brightness;
     }
 
@@ -227,6 +226,7 @@ class PixelPusher
 
    private:
     void HandlePusherCommand(const uint8_t* buffer, uint32_t size);
+    void Update();
 
     /**
      * @brief Static callback function for receiving UDP packets.
@@ -247,9 +247,11 @@ class PixelPusher
     int32_t handle_data_{-1};
     uint32_t count_{0};
     uint32_t strip_data_length_{0};
-    uint32_t universes_{0};
-    uint32_t port_index_last_{0};
     uint32_t active_ports_{0};
+    uint32_t strips_received_{0}; ///< Bit per strip received since the last update
+    uint32_t millis_received_{0};
+    uint8_t brightness_{0};
+    bool is_brightness_pending_{false};
     bool has_global_brightness_{false};
 
     DmxNodeOutputType* dmxnode_output_type_{nullptr};
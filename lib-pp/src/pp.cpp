@@ -36,15 +36,16 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <algorithm>
 #include <cassert>
 
 #include "pp.h"
 #include "network_config.h"
 #include "network_iface.h"
 #include "network_udp.h"
+#include "core/protocol/udp.h"
 #include "timing.h"
-#include "dmxnodedata.h"
-#include "dmxnode_data.h"
 #include "firmware/debug/debug_debug.h"
 
 namespace {
@@ -75,7 +76,6 @@ PixelPusher::PixelPusher() : millis_(timing::Millis()) {
     //
     discovery_packet_.pixelpusher.base.update_period = 1000;
     discovery_packet_.pixelpusher.base.power_total = 1;
-    discovery_packet_.pixelpusher.base.max_strips_per_packet = 1; // TODO (a) This can be active_ports_ ?
     discovery_packet_.pixelpusher.base.my_port = pp::UDP_PORT_DATA;
     //
     discovery_packet_.pixelpusher.ext.segments = 1;
@@ -87,6 +87,13 @@ void PixelPusher::Start() {
     DEBUG_ENTRY();
     assert(dmxnode_output_type_ != nullptr);
 
+    // The strip data is always RGB, RGBW and 16-bit pixels cannot be driven
+    if (dmxnode_output_type_->GetSlotsPerPixel() != pp::configuration::CHANNELS_PER_PIXEL) {
+        printf("PixelPusher: %u slots per pixel is not supported\n", static_cast<unsigned>(dmxnode_output_type_->GetSlotsPerPixel()));
+        count_ = 0;
+        active_ports_ = 0;
+    }
+
     handle_discovery_ = network::udp::Begin(pp::UDP_PORT_DISCOVERY, nullptr);
     assert(handle_discovery_ != -1);
 
@@ -101,14 +108,18 @@ void PixelPusher::Start() {
     discovery_packet_.pixelpusher.base.pixels_per_strip = static_cast<uint16_t>(count_);
     discovery_packet_.pixelpusher.ext.strip_count_16 = static_cast<uint16_t>(active_ports_);
 #if !defined(CONFIG_PP_16BITSTUFF)
-    discovery_packet_.pixelpusher.ext.pusher_flags = 0;
+    discovery_packet_.pixelpusher.ext.pusher_flags = has_global_brightness_ ? static_cast<uint32_t>(pp::PusherFlags::GLOBAL_BRIGHTNESS) : 0;
 #else
-    static const uint32_t nPusherFlags = (m_hasGlobalBrightness ? static_cast<uint32_t>(pp::PusherFlags::GLOBAL_BRIGHTNESS) : 0) | static_cast<uint32_t>(pp::PusherFlags::DYNAMICS) | static_cast<uint32_t>(pp::PusherFlags::_16BITSTUFF);
+    static const uint32_t nPusherFlags = (has_global_brightness_ ? static_cast<uint32_t>(pp::PusherFlags::GLOBAL_BRIGHTNESS) : 0) | static_cast<uint32_t>(pp::PusherFlags::DYNAMICS) | static_cast<uint32_t>(pp::PusherFlags::_16BITSTUFF);
     discovery_packet_.pixelpusher.ext.pusher_flags = nPusherFlags;
 #endif
 
     strip_data_length_ = 1U + count_ * pp::configuration::CHANNELS_PER_PIXEL;
 
+    // As many strips as fit in a datagram, after the sequence number
+    const auto kStripsPerPacket = (network::udp::kDataSize - 4U) / strip_data_length_;
+    discovery_packet_.pixelpusher.base.max_strips_per_packet = static_cast<uint8_t>(std::max(1U, std::min(kStripsPerPacket, active_ports_)));
+
     DEBUG_EXIT();
 }
 
@@ -125,7 +136,7 @@ void PixelPusher::Stop() {
 }
 
 void PixelPusher::Input(const uint8_t* buffer, uint32_t size, [[maybe_unused]] uint32_t from_ip, [[maybe_unused]] uint16_t from_port) {
-    if (__builtin_expect((size < 4), 0)) return;
+    if (__builtin_expect((size < 4) || (active_ports_ == 0), 0)) return;
 
     auto* data = buffer;
 
@@ -147,37 +158,55 @@ void PixelPusher::Input(const uint8_t* buffer, uint32_t size, [[maybe_unused]] u
 
     const auto kReceivedStrips = size / strip_data_length_;
 
-    for (uint32_t i = 0; i < kReceivedStrips; i++) {
-        const auto kPortIndexStart = data[0] * universes_;
-        uint32_t port_index;
-        for (port_index = kPortIndexStart; port_index < (kPortIndexStart + universes_) && (size > 0); port_index++) {
-            const auto kLength = std::min(std::min(size, pp::configuration::UNIVERSE_MAX_LENGTH), strip_data_length_ - 1);
-
-            //          DEBUG_PRINTF("i=%u, port_index=%u, size=%u, kLength=%u", i, port_index, size, kLength);
+    /*
+     * The strips go straight into the pixel output. A frame is complete when all active
+     * strips are received, or when a strip is received again.
+     */
+    for (uint32_t i = 0; i < kReceivedStrips; i++, data += strip_data_length_) {
+        const uint32_t kStrip = data[0];
 
-            dmxnode::Data::SetSourceA(port_index, &data[1], kLength);
-
-            size -= kLength;
-            data += kLength;
+        if (kStrip >= active_ports_) {
+            continue;
         }
 
-        data += strip_data_length_;
+        if ((strips_received_ & (1U << kStrip)) != 0) {
+            Update();
+        }
 
-        //		DEBUG_PRINTF("nPortIndex=%u, port_index_last_=%u", nPortIndex, port_index_last_);
+        dmxnode_output_type_->SetStrip(kStrip, &data[1], strip_data_length_ - 1);
+        dmxnode_output_type_->Sync(kStrip);
+        strips_received_ |= (1U << kStrip);
+    }
 
-        if (port_index == port_index_last_) {
-            for (uint32_t type_port_index = 0; type_port_index < port_index_last_; type_port_index++) {
-                dmxnode::DataOutput(dmxnode_output_type_, type_port_index);
-                dmxnode::Data::ClearLength(type_port_index);
-            }
-        }
+    if (strips_received_ == ((1U << active_ports_) - 1U)) {
+        Update();
     }
+
+    millis_received_ = timing::Millis();
 #else
 #endif
 }
 
+void PixelPusher::Update() {
+    dmxnode_output_type_->Sync();
+    strips_received_ = 0;
+}
+
 void PixelPusher::Run() {
     const auto kMillis = timing::Millis();
+
+    // Rebuilding the lookup table is too slow for the receive callback
+    if (__builtin_expect(is_brightness_pending_, 0)) {
+        is_brightness_pending_ = false;
+        dmxnode_output_type_->SetBrightness(brightness_);
+    }
+
+    if (__builtin_expect((strips_received_ != 0), 0)) {
+        if ((kMillis - millis_received_) >= pp::configuration::FRAME_TIMEOUT_MILLIS) {
+            Update();
+        }
+    }
+
     if (__builtin_expect((kMillis - millis_ < 1000), 1)) {
         return;
     }
@@ -188,10 +217,31 @@ void PixelPusher::Run() {
     network::udp::Send(handle_discovery_, reinterpret_cast<const uint8_t*>(&discovery_packet_), sizeof(struct pp::DiscoveryPacket), UINT32_MAX, pp::UDP_PORT_DISCOVERY);
 }
 
+/*
+ * The brightness is folded into the lookup table of the pixel output in Run,
+ * a following frame is shown with it.
+ */
 void PixelPusher::HandlePusherCommand([[maybe_unused]] const uint8_t* buffer, [[maybe_unused]] uint32_t size) {
     DEBUG_ENTRY();
     DEBUG_PRINTF("pBuffer=%p, nSize=%u", reinterpret_cast<const void*>(buffer), static_cast<unsigned>(size));
 #if !defined(CONFIG_PP_16BITSTUFF)
+    if (size < 1) {
+        DEBUG_EXIT();
+        return;
+    }
+
+    const auto kType = static_cast<pp::command::Type>(buffer[0]);
+
+    if ((kType == pp::command::Type::GLOBAL_BRIGHTNESS) && has_global_brightness_ && (size >= 3)) {
+        uint16_t brightness;
+        memcpy(&brightness, &buffer[1], sizeof(uint16_t));
+
+        // The lookup table is only rebuilt when the value changes
+        brightness_ = static_cast<uint8_t>(brightness >> 8);
+        is_brightness_pending_ = true;
+
+        DEBUG_PRINTF("brightness=%u", static_cast<unsigned>(brightness));
+    }
 #else
 #endif
     DEBUG_EXIT();
@@ -202,6 +252,4 @@ void PixelPusher::Print() {
     printf(" Count             : %u\n", static_cast<unsigned>(count_));
     printf(" Channels per pixel: %u\n", static_cast<unsigned>(pp::configuration::CHANNELS_PER_PIXEL));
     printf(" Active ports      : %u\n", static_cast<unsigned>(active_ports_));
-    DEBUG_PRINTF("universes_=%u", static_cast<unsigned>(universes_));
-    DEBUG_PRINTF("port_index_last_=%u", static_cast<unsigned>(port_index_last_));
 }
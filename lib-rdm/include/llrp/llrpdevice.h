@@ -39,6 +39,7 @@
 #include "rdmhandler.h"
 #include "ip4/ip4_address.h"
 #include "rdmdevice.h"
+#include "softwaretimers.h"
 #include "rdm_debug.h"
 
 namespace llrp::device {
@@ -66,6 +67,10 @@ class LLRPDevice {
     ~LLRPDevice() {
         LLRP_DEVICE_DEBUG_ENTRY();
 
+        if (s_probe_timer_id != kTimerIdNone) {
+            SoftwareTimerDelete(s_probe_timer_id);
+        }
+
         network::apps::mdns::ServiceRecordDelete(network::apps::mdns::Services::kRdmnetLlrp);
 
         network::igmp::LeaveGroup(handle_llrp, llrp::device::kIpV4LlrpRequest);
@@ -126,6 +131,8 @@ class LLRPDevice {
 
     void HandleRequestMessage();
     void HandleRdmCommand();
+    static void SendProbeReply();
+    static void ProbeReplyTimer(TimerHandle_t handle);
     // DEBUG subject for deletions
     void DumpCommon();
     void DumpLLRP();
@@ -137,6 +144,8 @@ class LLRPDevice {
     static inline uint32_t ip_address_from;
     static inline uint8_t* llrp;
     static inline TRdmMessage rdm_command;
+    static inline TTProbeReplyPDUPacket s_probe_reply;
+    static inline TimerHandle_t s_probe_timer_id{kTimerIdNone};
     static inline LLRPDevice* s_this;
 };
 
@@ -148,23 +148,24 @@ class RDMSensor {
 
     const struct rdm::sensor::Defintion* GetDefintion() { return &sensor_defintion_; }
 
-    const struct rdm::sensor::Values* GetValues() {
-        DEBUG_ENTRY();
+    /*
+     * Reads the sensor driver, called from the RDMSensors sampler.
+     * The RDM and JSON readers only use the cached values.
+     */
+    void Sample() {
         const auto kValue = this->GetValue();
 
         sensor_values_.present = kValue;
         sensor_values_.lowest_detected = std::min(sensor_values_.lowest_detected, kValue);
         sensor_values_.highest_detected = std::max(sensor_values_.highest_detected, kValue);
-
-        DEBUG_EXIT();
-        return &sensor_values_;
     }
 
+    const struct rdm::sensor::Values* GetValues() const { return &sensor_values_; }
+
     void SetValues() {
         DEBUG_ENTRY();
-        const auto kValue = this->GetValue();
+        const auto kValue = sensor_values_.present;
 
-        sensor_values_.present = kValue;
         sensor_values_.lowest_detected = kValue;
         sensor_values_.highest_detected = kValue;
         sensor_values_.recorded = kValue;
@@ -174,12 +175,8 @@ class RDMSensor {
 
     void Record() {
         DEBUG_ENTRY();
-        const auto kValue = this->GetValue();
 
-        sensor_values_.present = kValue;
-        sensor_values_.recorded = kValue;
-        sensor_values_.lowest_detected = std::min(sensor_values_.lowest_detected, kValue);
-        sensor_values_.highest_detected = std::max(sensor_values_.highest_detected, kValue);
+        sensor_values_.recorded = sensor_values_.present;
 
         DEBUG_EXIT();
     }
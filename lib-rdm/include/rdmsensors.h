@@ -31,6 +31,7 @@
 
 #include "configurationstore.h"
 #include "rdmsensor.h"
+#include "softwaretimers.h"
 #include "firmware/debug/debug_debug.h"
 
 #if !defined(__APPLE__)
@@ -49,7 +50,19 @@
 #include "json/rdmsensorsparams.h"
 #endif
 
+/*
+ * The sensors are sampled in the background, one sensor per timer tick.
+ * A driver doing a blocking I2C transaction therefore never runs while
+ * an RDM GET_SENSOR_VALUE is being answered.
+ */
 class RDMSensors {
+    static constexpr uint32_t kSampleIntervalMillis =
+#if defined(CONFIG_RDM_SENSORS_SAMPLE_INTERVAL_MILLIS)
+        CONFIG_RDM_SENSORS_SAMPLE_INTERVAL_MILLIS;
+#else
+        250;
+#endif
+
    public:
     RDMSensors() {
         DEBUG_ENTRY();
@@ -74,6 +87,10 @@ class RDMSensors {
 
     ~RDMSensors() {
         DEBUG_ENTRY();
+        if (s_timer_id != kTimerIdNone) {
+            SoftwareTimerDelete(s_timer_id);
+        }
+
         for (uint32_t i = 0; i < count_; i++) {
             if (rdm_sensor_[i] != nullptr) {
                 delete rdm_sensor_[i];
@@ -100,6 +117,12 @@ class RDMSensors {
 
         assert(rdm_sensor != nullptr);
         rdm_sensor_[count_++] = rdm_sensor;
+        // Initial value, before the first background sample
+        rdm_sensor->Sample();
+
+        if (s_timer_id == kTimerIdNone) {
+            s_timer_id = SoftwareTimerAdd(kSampleIntervalMillis, Timer);
+        }
 
         DEBUG_PRINTF("count_=%u", count_);
         DEBUG_EXIT();
@@ -114,7 +137,7 @@ class RDMSensors {
         return rdm_sensor_[sensor]->GetDefintion();
     }
 
-    const struct rdm::sensor::Values* GetValues(uint8_t sensor) {
+    const struct rdm::sensor::Values* GetValues(uint8_t sensor) const {
         assert(sensor < count_);
         assert(rdm_sensor_[sensor] != nullptr);
         return rdm_sensor_[sensor]->GetValues();
@@ -144,11 +167,24 @@ class RDMSensors {
 
     static RDMSensors* Get() { return s_this; }
 
+   private:
+    static void Timer([[maybe_unused]] TimerHandle_t handle) {
+        auto& sensors = *s_this;
+
+        if (sensors.next_ >= sensors.count_) {
+            sensors.next_ = 0;
+        }
+
+        sensors.rdm_sensor_[sensors.next_++]->Sample();
+    }
+
    private:
     RDMSensor** rdm_sensor_{nullptr};
     uint8_t count_{0};
+    uint8_t next_{0}; ///< Next sensor to sample
 
     inline static RDMSensors* s_this;
+    inline static TimerHandle_t s_timer_id{kTimerIdNone};
 };
 
 #endif // RDMSENSORS_H_
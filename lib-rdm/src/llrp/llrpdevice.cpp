@@ -24,17 +24,20 @@
 
 #include <cstdint>
 #include <cstring>
+#include <cstdlib> // IWYU pragma: keep // Needed for random())
 #include <cassert>
 
 #include "uuid.h"
 #include "llrp/llrpdevice.h"
 #include "llrp/llrppacket.h"
+#include "llrp/llrp.h"
 #include "e133.h"
 #include "network_iface.h"
 #include "rdmconst.h"
 #include "rdm_e120.h"
 #include "rdm_device_base.h"
 #include "rdm_message_print.h"
+#include "softwaretimers.h"
 #include "firmware/debug/debug_dump.h"
 #include "rdm_debug.h"
 
@@ -43,53 +46,85 @@
 #define DEBUG_RDM_SHOW_MESSAGE
 #endif
 
+/*
+ * E1.33 does not require the Known UIDs list to be sorted
+ */
+static bool IsKnownUid(const uint8_t* known_uids, uint32_t count, const uint8_t* uid) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (memcmp(&known_uids[i * rdm::kUidSize], uid, rdm::kUidSize) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void LLRPDevice::HandleRequestMessage() {
     LLRP_DEVICE_DEBUG_ENTRY();
 
     const auto* request = reinterpret_cast<struct TProbeRequestPDUPacket*>(llrp);
+    const auto* uid = rdm::device::Base::Instance().GetUID();
+
+    debug::Dump(request->ProbeRequestPDU.LowerUUID, 2 * rdm::kUidSize);
+
+    if (!((memcmp(request->ProbeRequestPDU.LowerUUID, uid, rdm::kUidSize) <= 0) && (memcmp(uid, request->ProbeRequestPDU.UpperUUID, rdm::kUidSize) <= 0))) {
+        LLRP_DEVICE_DEBUG_PUTS("Not for me");
+        LLRP_DEVICE_DEBUG_EXIT();
+        return;
+    }
+
     const auto* pdu = request->ProbeRequestPDU.flags_length;
     const auto kLength = (static_cast<uint32_t>((pdu[0] & 0x0fu) << 16) | static_cast<uint32_t>(pdu[1] << 8) | pdu[2]);
 
-    uint8_t uid[rdm::kUidSize];
-    memcpy(uid, rdm::device::Base::Instance().GetUID(), rdm::kUidSize);
-
     if (kLength > 18) {
         const auto kKnownUiDs = (kLength - 18) / rdm::kUidSize;
-        const auto* p = request->ProbeRequestPDU.KnownUUIDs;
 
-        for (uint32_t index = 0; index < kKnownUiDs; index++) {
-            if (memcmp(p, uid, rdm::kUidSize) == 0) {
-                LLRP_DEVICE_DEBUG_EXIT();
-                return;
+        if (IsKnownUid(request->ProbeRequestPDU.KnownUUIDs, kKnownUiDs, uid)) {
+            // The manager already knows us, a reply still pending for it is not needed anymore
+            if ((s_probe_timer_id != kTimerIdNone) && (memcmp(s_probe_reply.Common.LlrpPDU.DestinationCid, request->Common.RootLayerPDU.SenderCid, 16) == 0)) {
+                SoftwareTimerDelete(s_probe_timer_id);
+                LLRP_DEVICE_DEBUG_PUTS("Reply cancelled");
             }
-            p += rdm::kUidSize;
+            LLRP_DEVICE_DEBUG_EXIT();
+            return;
         }
     }
 
-    debug::Dump(request->ProbeRequestPDU.LowerUUID, 2 * rdm::kUidSize);
-
-    if (!((memcmp(request->ProbeRequestPDU.LowerUUID, uid, rdm::kUidSize) <= 0) && (memcmp(uid, request->ProbeRequestPDU.UpperUUID, rdm::kUidSize) <= 0))) {
-        LLRP_DEVICE_DEBUG_PUTS("Not for me");
-        LLRP_DEVICE_DEBUG_EXIT();
-        return;
-    }
+    auto* reply = &s_probe_reply;
 
-    auto* reply = reinterpret_cast<struct TTProbeReplyPDUPacket*>(llrp);
+    if (s_probe_timer_id != kTimerIdNone) {
+        // Same manager: the pending reply answers this request, with its transaction number
+        if (memcmp(reply->Common.LlrpPDU.DestinationCid, request->Common.RootLayerPDU.SenderCid, 16) == 0) {
+            reply->Common.LlrpPDU.TransactionNumber = request->Common.LlrpPDU.TransactionNumber;
+            LLRP_DEVICE_DEBUG_PUTS("Reply pending");
+            LLRP_DEVICE_DEBUG_EXIT();
+            return;
+        }
 
-    uint8_t destination_cid[16];
-    memcpy(destination_cid, reply->Common.RootLayerPDU.SenderCid, 16);
+        // Another manager: there is one reply buffer, the pending reply goes out now
+        SoftwareTimerDelete(s_probe_timer_id);
+        SendProbeReply();
+    }
 
-    // Root Layer PDU
+    // Keeps the transaction number of the request
+    memcpy(&reply->Common, &request->Common, sizeof(struct TLLRPCommonPacket));
+    // Root Layer PDU, the request can be longer than 255 bytes
+    reply->Common.RootLayerPDU.flags_length[0] = 0xF0;
+    reply->Common.RootLayerPDU.flags_length[1] = 0;
     reply->Common.RootLayerPDU.flags_length[2] = 67;
     UuidCopy(reply->Common.RootLayerPDU.SenderCid);
     // LLRP PDU
+    reply->Common.LlrpPDU.flags_length[0] = 0xF0;
+    reply->Common.LlrpPDU.flags_length[1] = 0;
     reply->Common.LlrpPDU.flags_length[2] = 44;
     reply->Common.LlrpPDU.vector = __builtin_bswap32(VECTOR_LLRP_PROBE_REPLY);
-    memcpy(reply->Common.LlrpPDU.DestinationCid, destination_cid, 16);
+    memcpy(reply->Common.LlrpPDU.DestinationCid, request->Common.RootLayerPDU.SenderCid, 16);
     // Probe Reply PDU
+    reply->ProbeReplyPDU.flags_length[0] = 0xF0;
+    reply->ProbeReplyPDU.flags_length[1] = 0;
     reply->ProbeReplyPDU.flags_length[2] = 17;
     reply->ProbeReplyPDU.vector = VECTOR_PROBE_REPLY_DATA;
-    memcpy(reply->ProbeReplyPDU.UID, rdm::device::Base::Instance().GetUID(), rdm::kUidSize);
+    memcpy(reply->ProbeReplyPDU.UID, uid, rdm::kUidSize);
     network::iface::CopyMacAddressTo(reply->ProbeReplyPDU.HardwareAddress);
 #if defined(NODE_RDMNET_LLRP_ONLY)
     reply->ProbeReplyPDU.ComponentType = LLRP_COMPONENT_TYPE_NON_RDMNET;
@@ -97,14 +132,32 @@ void LLRPDevice::HandleRequestMessage() {
     reply->ProbeReplyPDU.ComponentType = LLRP_COMPONENT_TYPE_RPT_DEVICE;
 #endif
 
-    network::udp::Send(handle_llrp, reinterpret_cast<const uint8_t*>(reply), sizeof(struct TTProbeReplyPDUPacket), llrp::device::kIpV4LlrpResponse, llrp::device::kLlrpPort);
+    // E1.33 5.7.1 Send the reply after a random delay, so the targets do not all reply at once
+    const auto kDelay = 1U + (static_cast<uint32_t>(random()) % LLRP_MAX_BACKOFF_MS);
+    s_probe_timer_id = SoftwareTimerAddOneShot(kDelay, ProbeReplyTimer);
+
+    if (s_probe_timer_id == kTimerIdNone) {
+        SendProbeReply();
+    }
+
+    LLRP_DEVICE_DEBUG_PRINTF("kDelay=%u", kDelay);
+    LLRP_DEVICE_DEBUG_EXIT();
+}
+
+void LLRPDevice::SendProbeReply() {
+    LLRP_DEVICE_DEBUG_ENTRY();
+
+    network::udp::Send(handle_llrp, reinterpret_cast<const uint8_t*>(&s_probe_reply), sizeof(struct TTProbeReplyPDUPacket), llrp::device::kIpV4LlrpResponse, llrp::device::kLlrpPort);
 
-#ifndef NDEBUG
-    DumpCommon();
-#endif
     LLRP_DEVICE_DEBUG_EXIT();
 }
 
+void LLRPDevice::ProbeReplyTimer([[maybe_unused]] TimerHandle_t handle) {
+    // One-shot, the timer is deleted after the callback has returned
+    s_probe_timer_id = kTimerIdNone;
+    SendProbeReply();
+}
+
 void LLRPDevice::HandleRdmCommand() {
     LLRP_DEVICE_DEBUG_ENTRY();
 
@@ -39,6 +39,26 @@ function formatUploadSize(bytes) {
 	return (unit === 0 ? size.toString() : size.toFixed(1)) + ' ' + units[unit];
 }
 
+const crc32Table = (function() {
+	const table = new Uint32Array(256);
+	for (let n = 0; n < 256; n++) {
+		let c = n;
+		for (let k = 0; k < 8; k++) {
+			c = (c & 1) ? (0xEDB88320 ^ (c >>> 1)) : (c >>> 1);
+		}
+		table[n] = c >>> 0;
+	}
+	return table;
+})();
+
+function crc32Update(crc, bytes) {
+	crc = (crc ^ 0xFFFFFFFF) >>> 0;
+	for (let i = 0; i < bytes.length; i++) {
+		crc = crc32Table[(crc ^ bytes[i]) & 0xFF] ^ (crc >>> 8);
+	}
+	return (crc ^ 0xFFFFFFFF) >>> 0;
+}
+
 function selectedFirmwareFile() {
 	const input = uploadEl('firmwareInput');
 	return input && input.files && input.files.length > 0 ? input.files[0] : null;
@@ -107,8 +127,11 @@ async function uploadFirmware() {
 			signal: signal
 		}, 'Upload start failed');
 
+		let crc = 0;
+
 		for (let offset = 0; offset < file.size; offset += chunkSize) {
 			const chunk = file.slice(offset, offset + chunkSize);
+			crc = crc32Update(crc, new Uint8Array(await chunk.arrayBuffer()));
 			const chunkNumber = Math.floor(offset / chunkSize) + 1;
 
 			setUploadStatus('Uploading chunk ' + chunkNumber + ' / ' + totalChunks);
@@ -130,7 +153,13 @@ async function uploadFirmware() {
 		}
 
 		setUploadStatus('Completing');
-		await checkedFetch('/upload_complete', { method: 'POST', signal: signal }, 'Upload complete failed');
+		await checkedFetch('/upload_complete', {
+			method: 'POST',
+			headers: {
+				'X-Upload-Crc': crc.toString()
+			},
+			signal: signal
+		}, 'Upload complete failed');
 		setUploadProgress(file.size, file.size);
 		setUploadStatus('Complete');
 		logUpload('Upload complete.');
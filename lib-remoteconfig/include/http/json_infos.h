@@ -33,12 +33,13 @@
 
 namespace json
 {
+class Writer;
 
 struct Info
 {
     constexpr Info(uint32_t (*get_in)(char*, uint32_t), void (*set_in)(const char*, uint32_t), void (*del_in)(const char*, uint32_t), const char* name_in,
-                   uint8_t length_in, uint32_t hash_in, const char* config_in, const char* status_in) noexcept
-        : get(get_in), set(set_in), del(del_in), name(name_in), length(length_in), hash(hash_in), config_label(config_in), status_label(status_in)
+                   uint8_t length_in, uint32_t hash_in, const char* config_in, const char* status_in, void (*stream_in)(Writer&) = nullptr) noexcept
+        : get(get_in), set(set_in), del(del_in), name(name_in), length(length_in), hash(hash_in), config_label(config_in), status_label(status_in), stream(stream_in)
     {
     }
 
@@ -50,6 +51,7 @@ struct Info
     uint32_t hash;
     const char* config_label;
 	const char* status_label;
+    void (*stream)(Writer&); // Streamed with chunked transfer encoding, bounded by the TCP transmit queue
 };
 
 template <size_t N>
@@ -59,6 +61,12 @@ constexpr Info MakeJsonFileInfo(uint32_t (*get)(char*, uint32_t), void (*set)(co
     return Info{get, set, del, str, static_cast<uint8_t>(N - 1), hash, config_label, status_label};
 }
 
+template <size_t N>
+constexpr Info MakeJsonStreamInfo(void (*stream)(Writer&), const char (&str)[N], uint32_t hash, const char* status_label)
+{
+    return Info{nullptr, nullptr, nullptr, str, static_cast<uint8_t>(N - 1), hash, nullptr, status_label, stream};
+}
+
 constexpr bool HasUniqueHashes(const Info* entries, size_t count)
 {
     for (size_t i = 0; i < count; ++i)
@@ -31,6 +31,7 @@
 #include "http/http.h"
 #include "core/protocol/tcp.h" // IWYU pragma: keep
 #include "network_tcp.h"
+#include "httpd/httpdupload.h"
 #include "httpd/httpd_debug.h"
 
 namespace httpd {
@@ -41,8 +42,16 @@ static constexpr uint32_t kBufsize =
     HTTPD_CONTENT_SIZE;
 #endif
 static constexpr uint32_t kUploadFilenameMaxLength = 32;
+// Chunked transfer encoding: "XXXX\r\n" + data + "\r\n"
+static constexpr uint32_t kChunkHeaderSize = 6;
+static constexpr uint32_t kChunkTrailerSize = 2;
+static_assert(kBufsize - kChunkHeaderSize - kChunkTrailerSize <= 0xFFFF);
 } // namespace httpd
 
+namespace json {
+class Writer;
+} // namespace json
+
 class HttpDeamonHandleRequest {
    public:
     explicit HttpDeamonHandleRequest(network::tcp::ConnHandle connection_handle) : connection_handle_(connection_handle) {
@@ -67,6 +76,8 @@ class HttpDeamonHandleRequest {
     http::Status HandleDelete();
     http::Status HandlePostJSON();
     http::Status HandlePostUpload();
+    void SendStream();
+    static void SendChunk(char* buffer, uint32_t length, void* context);
 
     network::tcp::ConnHandle connection_handle_;
     uint32_t content_size_{0};
@@ -74,18 +85,23 @@ class HttpDeamonHandleRequest {
     uint32_t request_content_length_{0};
     uint32_t bytes_received_{0};
     uint32_t upload_size_{0};
+    uint32_t upload_offset_{httpd::upload::kOffsetNone};
+    uint32_t upload_crc_{0};
 
     char* uri_{nullptr};
     char* file_data_{nullptr};
     char* firmwarefile_name_{nullptr};
     char* receive_buffer_{nullptr};
     const uint8_t* content_{nullptr};
+    void (*stream_)(json::Writer&){nullptr};
     char upload_filename_[httpd::kUploadFilenameMaxLength];
 
     http::Status status_{http::Status::kUnknownError};
     http::RequestMethod request_method_{http::RequestMethod::kUnknown};
     http::ContentTypes request_content_type_{http::ContentTypes::kNotDefined};
     bool gzip_{false};
+    bool has_upload_crc_{false};
+    bool is_send_error_{false};
 
     char dynamic_content_[httpd::kBufsize];
 };
@@ -0,0 +1,69 @@
+/**
+ * @file httpdupload.h
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef HTTPD_HTTPDUPLOAD_H_
+#define HTTPD_HTTPDUPLOAD_H_
+
+#include <cstdint>
+
+#include "core/protocol/tcp.h" // IWYU pragma: keep
+
+/*
+ * Firmware upload pipeline.
+ *
+ * The HTTP handler only copies the received chunk into a ring of segments
+ * and replies. Erasing and programming the flash is done from a software
+ * timer in the super loop, so the client is already sending the next chunk
+ * while the previous one is being programmed.
+ * A CRC-32 (zlib) is computed over the data in arrival order.
+ */
+namespace httpd::upload {
+static constexpr uint32_t kSegmentSize = network::tcp::kTcpDataMss;
+static constexpr uint32_t kSegments =
+#if defined(CONFIG_HTTPD_UPLOAD_SEGMENTS)
+    CONFIG_HTTPD_UPLOAD_SEGMENTS;
+#else
+    4;
+#endif
+static_assert((kSegments & (kSegments - 1)) == 0, "kSegments must be a power of 2");
+
+static constexpr uint32_t kOffsetNone = UINT32_MAX;
+
+enum class Result { kOk, kDuplicate, kOutOfOrder, kCrcMismatch, kError };
+
+bool Start(uint32_t size);
+/**
+ * @param offset Offset of data in the file, kOffsetNone when the client did not send one
+ */
+Result Push(const uint8_t* data, uint32_t length, uint32_t offset);
+/**
+ * Drains the ring, checks the CRC and only then finalises the flash write.
+ * @param is_crc_checked The client sent a CRC
+ * @param crc CRC-32 sent by the client
+ */
+Result Complete(bool is_crc_checked, uint32_t crc, uint32_t& write_count);
+} // namespace httpd::upload
+
+#endif // HTTPD_HTTPDUPLOAD_H_
@@ -24,30 +24,23 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <cstdio>
 
 #include "http/json_infos.h"
+#include "json/json_writer.h"
 
 namespace json::status {
-uint32_t Directory(char* out_buffer, uint32_t out_buffer_size) {
-    uint32_t total = 0;
-
-    total += static_cast<uint32_t>(snprintf(out_buffer + total, out_buffer_size - total, "{\"files\":{"));
+void Directory(Writer& writer) {
+    writer.ObjectBegin();
+    writer.ObjectBegin("files");
 
     for (size_t i = 0; i < kFileInfosSize; ++i) {
         const auto& entry = kFileInfos[i];
         if ((entry.status_label != nullptr) && (entry.status_label[0] != '\0')) {
-            total += static_cast<uint32_t>(snprintf(out_buffer + total, out_buffer_size - total, "\"%s\":\"%s\"%s", entry.name, entry.status_label, (i + 1 < kFileInfosSize) ? "," : ""));
+            writer.Field(entry.name, entry.status_label);
         }
     }
 
-    if (out_buffer[total - 1] == ',') {
-        out_buffer[total - 1] = '}';
-    } else {
-        out_buffer[total++] = '}';
-    }
-
-    out_buffer[total++] = '}';
-    return total;
+    writer.ObjectEnd();
+    writer.ObjectEnd();
 }
 } // namespace json::status
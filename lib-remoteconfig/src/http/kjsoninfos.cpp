@@ -42,19 +42,21 @@ uint32_t ShowFileDirectory(char*, uint32_t);
 
 // Status
 namespace status {
-uint32_t Directory(char*, uint32_t);
+void Directory(Writer&);
 uint32_t Identify(char*, uint32_t);
 uint32_t Display(char*, uint32_t);
-uint32_t Dmx(char*, uint32_t);
+void Dmx(Writer&);
 uint32_t Rdm(char*, uint32_t);
 uint32_t RdmQueue(char*, uint32_t);
 uint32_t ShowFile(char*, uint32_t);
-uint32_t Pixel(char*, uint32_t);
+void Pixel(Writer&);
 uint32_t PixelDmx(char*, uint32_t);
+void Profile(Writer&);
+void Timers(Writer&);
 
 namespace emac {
-uint32_t Phy(char*, uint32_t);
-uint32_t Emac(char*, uint32_t);
+void Phy(Writer&);
+void Emac(Writer&);
 } // namespace net
 } // namespace status
 
@@ -173,6 +175,7 @@ void SetDmxL6470Motor7(const char*, uint32_t);
 } // namespace config
 
 #define ENTRY(get, set, del, filename_literal, config_label, status_label) MakeJsonFileInfo(get, set, del, filename_literal, Fnv1a32(filename_literal, static_cast<uint8_t>(sizeof(filename_literal) - 1)), config_label, status_label)
+#define ENTRY_STREAM(stream, filename_literal, status_label) MakeJsonStreamInfo(stream, filename_literal, Fnv1a32(filename_literal, static_cast<uint8_t>(sizeof(filename_literal) - 1)), status_label)
 
 constexpr Info kFileInfos[] = {
     ENTRY(GetList, nullptr, nullptr, "list", nullptr, nullptr), 
@@ -181,16 +184,16 @@ constexpr Info kFileInfos[] = {
 	ENTRY(GetTimeofday, SetTimeofday, nullptr, "timedate", nullptr, nullptr),
 #if !defined(CONFIG_HTTP_HTML_INDEX_ONLY)
     // Status
-	ENTRY(status::Directory, nullptr, nullptr, "status/directory", nullptr, nullptr),
+	ENTRY_STREAM(status::Directory, "status/directory", nullptr),
     ENTRY(status::Identify, nullptr, nullptr, "status/identify", nullptr, "Identify"), 
 	ENTRY(status::Display, nullptr, nullptr, "status/display", nullptr, "Display"), 
-	ENTRY(status::emac::Phy, nullptr, nullptr, "status/phy", nullptr, "Phy"),
-    ENTRY(status::emac::Emac, nullptr, nullptr, "status/emac", nullptr, "Emac"),
+	ENTRY_STREAM(status::emac::Phy, "status/phy", "Phy"),
+    ENTRY_STREAM(status::emac::Emac, "status/emac", "Emac"),
 #if defined(OUTPUT_DMX_SEND) || defined(OUTPUT_DMX_SEND_MULTI)
-    ENTRY(status::Dmx, nullptr, nullptr, "status/dmx", nullptr, "Dmx"),
+    ENTRY_STREAM(status::Dmx, "status/dmx", "Dmx"),
 #endif
 #if defined(DMXNODE_OUTPUT_PIXEL)
-    ENTRY(status::Pixel, nullptr, nullptr, "status/pixel", nullptr, "Pixel"), 
+    ENTRY_STREAM(status::Pixel, "status/pixel", "Pixel"), 
 	ENTRY(status::PixelDmx, nullptr, nullptr, "status/pixeldmx", nullptr, "PixelDmx"),
 #endif
 #if defined(RDM_CONTROLLER)
@@ -199,6 +202,12 @@ constexpr Info kFileInfos[] = {
 #endif
 #if defined(NODE_SHOWFILE)
     ENTRY(status::ShowFile, nullptr, nullptr, "status/showfile", nullptr, "Showfile"),
+#endif
+#if defined(CONFIG_DEBUG_PROFILE)
+    ENTRY_STREAM(status::Profile, "status/profile", "Profile"),
+#endif
+#if !defined(CONFIG_HAL_TIMERS_DISABLE_STATISTICS)
+    ENTRY_STREAM(status::Timers, "status/timers", "Timers"),
 #endif
     // Action
     ENTRY(nullptr, action::Set, nullptr, "action", nullptr, nullptr),
@@ -46,11 +46,11 @@
 #include "timing.h" // IWYU pragma: keep
 #include "http/html_infos.h"
 #include "http/json_infos.h"
+#include "json/json_writer.h"
 #include "network_tcp.h"
 #include "network_iface.h"
 #if defined(CONFIG_HTTPD_ENABLE_UPLOAD)
 #include "firmware.h"
-#include "flashcodeinstall.h"
 #include "display.h" // IWYU pragma: keep
 #endif
 #include "firmware/debug/debug_dump.h"
@@ -178,6 +178,9 @@ void HttpDeamonHandleRequest::HandleRequest(uint32_t bytes_received, char* recei
                                            static_cast<unsigned int>(status_), status_msg, network::iface::HostName(), http::kContentType[static_cast<uint32_t>(request_content_type_)], static_cast<unsigned int>(content_size_)));
 
         network::tcp::Send(connection_handle_, reinterpret_cast<const uint8_t*>(receive_buffer_), kHeaderLength);
+    } else if (stream_ != nullptr) {
+        SendStream();
+        content_size_ = 0;
     } else {
         const auto kHeaderLength = static_cast<uint32_t>(snprintf(receive_buffer_, network::tcp::kTcpDataMss,
                                                                   "HTTP/1.1 %u %s\r\n"
@@ -209,10 +212,79 @@ void HttpDeamonHandleRequest::HandleRequest(uint32_t bytes_received, char* recei
     request_data_length_ = 0;
     file_data_ = nullptr;
     firmwarefile_name_ = nullptr;
+    stream_ = nullptr;
+    upload_offset_ = httpd::upload::kOffsetNone;
+    has_upload_crc_ = false;
 
     HTTPD_DEBUG_EXIT();
 }
 
+/*
+ * The body is produced while it is being sent: the JSON writer fills
+ * dynamic_content_ behind a reserved chunk header and every full buffer
+ * goes out as one chunk, without an intermediate copy. The body is bounded
+ * by what the TCP transmit queue can hold, a send that does not fit aborts it.
+ */
+void HttpDeamonHandleRequest::SendStream() {
+    HTTPD_DEBUG_ENTRY();
+
+    const auto kHeaderLength = static_cast<uint32_t>(snprintf(receive_buffer_, network::tcp::kTcpDataMss,
+                                                              "HTTP/1.1 200 OK\r\n"
+                                                              "Server: %s\r\n"
+                                                              "Content-Type: %s\r\n"
+                                                              "Transfer-Encoding: chunked\r\n"
+                                                              "Cache-Control: no-cache\r\n"
+                                                              "Connection: close\r\n"
+                                                              "\r\n",
+                                                              network::iface::HostName(), http::kContentType[static_cast<uint32_t>(http::ContentTypes::kApplicationJson)]));
+
+    is_send_error_ = (network::tcp::Send(connection_handle_, reinterpret_cast<const uint8_t*>(receive_buffer_), kHeaderLength) < 0);
+
+    json::Writer writer(&dynamic_content_[httpd::kChunkHeaderSize], sizeof(dynamic_content_) - httpd::kChunkHeaderSize - httpd::kChunkTrailerSize, SendChunk, this);
+    (*stream_)(writer);
+    [[maybe_unused]] const auto kLength = writer.Finish();
+
+    static constexpr char kLastChunk[] = "0\r\n\r\n";
+
+    // A body with a missing chunk must not look complete to the client
+    if (is_send_error_ || (network::tcp::Send(connection_handle_, reinterpret_cast<const uint8_t*>(kLastChunk), sizeof(kLastChunk) - 1) < 0)) {
+        network::tcp::Abort(connection_handle_);
+        HTTPD_DEBUG_PUTS("Stream aborted");
+        HTTPD_DEBUG_EXIT();
+        return;
+    }
+
+    HTTPD_DEBUG_PRINTF("Streamed %u bytes", static_cast<unsigned>(kLength));
+    HTTPD_DEBUG_EXIT();
+}
+
+void HttpDeamonHandleRequest::SendChunk(char* buffer, uint32_t length, void* context) {
+    auto* handler = reinterpret_cast<HttpDeamonHandleRequest*>(context);
+    static constexpr char kHex[] = "0123456789ABCDEF";
+
+    // After a failed send the rest of the body is discarded
+    if (handler->is_send_error_) {
+        return;
+    }
+
+    // The chunk header is written right-aligned into the reserved space in front of the data
+    auto* begin = buffer;
+    *--begin = '\n';
+    *--begin = '\r';
+    auto size = length;
+    do {
+        *--begin = kHex[size & 0xF];
+        size >>= 4;
+    } while (size != 0);
+
+    buffer[length] = '\r';
+    buffer[length + 1] = '\n';
+
+    if (network::tcp::Send(handler->connection_handle_, reinterpret_cast<const uint8_t*>(begin), static_cast<uint32_t>(&buffer[length + 2] - begin)) < 0) {
+        handler->is_send_error_ = true;
+    }
+}
+
 http::Status HttpDeamonHandleRequest::ParseRequest() {
     char* line_buffer = receive_buffer_;
     uint32_t line_index = 0;
@@ -403,6 +475,27 @@ http::Status HttpDeamonHandleRequest::ParseHeaderField(char* line) {
         strncpy(upload_filename_, token, sizeof(upload_filename_) - 1);
         upload_filename_[sizeof(upload_filename_) - 1] = '\0';
 
+        return http::Status::kOk;
+    } else if (strcasecmp(token, "X-Upload-Offset") == 0) {
+        if ((token = strtok(nullptr, " ")) == nullptr) {
+            return http::Status::kBadRequest;
+        }
+
+        if (!ParseUint32(token, upload_offset_)) {
+            return http::Status::kBadRequest;
+        }
+
+        return http::Status::kOk;
+    } else if (strcasecmp(token, "X-Upload-Crc") == 0) {
+        if ((token = strtok(nullptr, " ")) == nullptr) {
+            return http::Status::kBadRequest;
+        }
+
+        if (!ParseUint32(token, upload_crc_)) {
+            return http::Status::kBadRequest;
+        }
+
+        has_upload_crc_ = true;
         return http::Status::kOk;
     }
 #endif
@@ -465,6 +558,11 @@ http::Status HttpDeamonHandleRequest::HandleGet() {
 
             if (kIndex >= 0) {
                 const auto& handler = json::kFileInfos[kIndex];
+                if (handler.stream != nullptr) {
+                    stream_ = handler.stream;
+                    HTTPD_DEBUG_EXIT();
+                    return http::Status::kOk;
+                }
                 if (handler.get != nullptr) {
                     length = (*(handler.get))(dynamic_content_, static_cast<uint32_t>(sizeof(dynamic_content_)));
                 }
@@ -575,9 +673,8 @@ http::Status HttpDeamonHandleRequest::HandlePostUpload() {
             return http::Status::kRequestEntityTooLarge;
         }
 
-        assert(FlashCodeInstall::Get() != nullptr);
-        if (!(FlashCodeInstall::Get()->Erase(upload_size_))) {
-            puts("Erase failed.");
+        if (!httpd::upload::Start(upload_size_)) {
+            puts("Upload start failed.");
             HTTPD_DEBUG_EXIT();
             return http::Status::kInternalServerError;
         }
@@ -594,10 +691,16 @@ http::Status HttpDeamonHandleRequest::HandlePostUpload() {
         if (part_uri[0] == 0) {
             Display::Get()->Progress();
 
-            uint32_t data_written;
-            printf("%u\n", static_cast<unsigned>(request_data_length_));
-            if (!(FlashCodeInstall::Get()->WriteChunk(reinterpret_cast<uint8_t*>(file_data_), request_data_length_, data_written))) {
-                HTTPD_DEBUG_PRINTF("WriteChunk failed. Data written:%u bytes", static_cast<unsigned>(data_written));
+            const auto kResult = httpd::upload::Push(reinterpret_cast<const uint8_t*>(file_data_), request_data_length_, upload_offset_);
+
+            if (kResult == httpd::upload::Result::kOutOfOrder) {
+                HTTPD_DEBUG_PRINTF("Out of order: offset=%u", static_cast<unsigned>(upload_offset_));
+                HTTPD_DEBUG_EXIT();
+                return http::Status::kBadRequest;
+            }
+
+            if (kResult == httpd::upload::Result::kError) {
+                HTTPD_DEBUG_PUTS("Upload failed.");
                 HTTPD_DEBUG_EXIT();
                 return http::Status::kInternalServerError;
             }
@@ -611,13 +714,21 @@ http::Status HttpDeamonHandleRequest::HandlePostUpload() {
 
     if (memcmp(part_uri, "_complete", 10) == 0) {
         uint32_t write_count;
-        if (!(FlashCodeInstall::Get()->WriteChunkComplete(write_count))) {
+        const auto kResult = httpd::upload::Complete(has_upload_crc_, upload_crc_, write_count);
+
+        if (kResult == httpd::upload::Result::kCrcMismatch) {
+            HTTPD_DEBUG_PUTS("CRC mismatch.");
+            HTTPD_DEBUG_EXIT();
+            return http::Status::kBadRequest;
+        }
+
+        if (kResult != httpd::upload::Result::kOk) {
             HTTPD_DEBUG_PUTS("WriteChunkComplete failed.");
             HTTPD_DEBUG_EXIT();
             return http::Status::kInternalServerError;
         }
 
-        printf("Written bytes -> %u [%s]\n", static_cast<unsigned>(write_count), write_count == upload_size_ ? "Ok" : "Wrong");
+        HTTPD_DEBUG_PRINTF("Written bytes -> %u [%s]", static_cast<unsigned>(write_count), write_count == upload_size_ ? "Ok" : "Wrong");
 
         content_size_ = static_cast<uint32_t>(snprintf(dynamic_content_, sizeof(dynamic_content_), "{\"status\":\"ok\"}"));
         content_ = reinterpret_cast<uint8_t*>(dynamic_content_);
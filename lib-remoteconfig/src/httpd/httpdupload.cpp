@@ -0,0 +1,217 @@
+/**
+ * @file httpdupload.cpp
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#if defined(CONFIG_HTTPD_ENABLE_UPLOAD)
+
+#if defined(__GNUC__) && !defined(__clang__)
+#if !defined(CONFIG_HTTPD_OPTIMIZE_NONE)
+#pragma GCC push_options
+#if defined(CONFIG_HTTPD_OPTIMIZE_O3)
+#pragma GCC optimize("O3")
+#else
+#pragma GCC optimize("O2")
+#endif
+#endif
+#endif
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+
+#include "httpd/httpdupload.h"
+#include "flashcodeinstall.h"
+#include "softwaretimers.h"
+#include "zlib.h"
+#include "httpd/httpd_debug.h"
+
+namespace httpd::upload {
+namespace {
+enum class State { kIdle, kErase, kProgram, kError };
+
+struct Segment {
+    uint32_t length;
+    alignas(uint32_t) uint8_t data[kSegmentSize];
+};
+
+Segment s_segments[kSegments];
+uint32_t s_head;   ///< Free running, next segment to fill
+uint32_t s_tail;   ///< Free running, next segment to program
+uint32_t s_size;   ///< Announced file size
+uint32_t s_offset; ///< Offset of the next expected byte
+uint32_t s_crc;
+State s_state{State::kIdle};
+TimerHandle_t s_timer_id = kTimerIdNone;
+
+/*
+ * One unit of flash work. Returns false when there is nothing left to do.
+ */
+bool Step() {
+    switch (s_state) {
+        case State::kErase:
+            if (!FlashCodeInstall::Get()->Erase(s_size)) {
+                puts("Erase failed.");
+                s_state = State::kError;
+                return false;
+            }
+            s_state = State::kProgram;
+            return true;
+        case State::kProgram: {
+            if (s_head == s_tail) {
+                return false;
+            }
+
+            auto& segment = s_segments[s_tail & (kSegments - 1)];
+            uint32_t data_written;
+
+            if (!FlashCodeInstall::Get()->WriteChunk(segment.data, segment.length, data_written)) {
+                HTTPD_DEBUG_PRINTF("WriteChunk failed. Data written:%u bytes", static_cast<unsigned>(data_written));
+                s_state = State::kError;
+                return false;
+            }
+
+            s_tail++;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+void TimerStop() {
+    if (s_timer_id != kTimerIdNone) {
+        SoftwareTimerDelete(s_timer_id);
+    }
+}
+
+void Timer([[maybe_unused]] TimerHandle_t handle) {
+    if (!Step()) {
+        TimerStop();
+    }
+}
+
+void TimerStart() {
+    if (s_timer_id == kTimerIdNone) {
+        s_timer_id = SoftwareTimerAdd(0, Timer);
+    }
+}
+} // namespace
+
+bool Start(uint32_t size) {
+    HTTPD_DEBUG_ENTRY();
+    assert(FlashCodeInstall::Get() != nullptr);
+
+    s_head = 0;
+    s_tail = 0;
+    s_size = size;
+    s_offset = 0;
+    s_crc = 0;
+    s_state = State::kErase;
+
+    // The erase runs after the reply to _start has been sent
+    TimerStart();
+
+    HTTPD_DEBUG_EXIT();
+    return s_timer_id != kTimerIdNone;
+}
+
+Result Push(const uint8_t* data, uint32_t length, uint32_t offset) {
+    assert(data != nullptr);
+    assert(length <= kSegmentSize);
+
+    if ((s_state == State::kIdle) || (s_state == State::kError)) {
+        return Result::kError;
+    }
+
+    if (offset != kOffsetNone) {
+        // A chunk the client sent again, because our reply got lost
+        if ((offset + length) <= s_offset) {
+            return Result::kDuplicate;
+        }
+        if (offset != s_offset) {
+            return Result::kOutOfOrder;
+        }
+    }
+
+    if ((s_offset + length) > s_size) {
+        return Result::kError;
+    }
+
+    // Ring full: program one segment now, this throttles the client
+    while ((s_head - s_tail) == kSegments) {
+        if (!Step()) {
+            return Result::kError;
+        }
+    }
+
+    auto& segment = s_segments[s_head & (kSegments - 1)];
+    memcpy(segment.data, data, length);
+    segment.length = length;
+
+    s_crc = crc32(s_crc, data, length);
+    s_offset += length;
+    s_head++;
+
+    TimerStart();
+
+    return Result::kOk;
+}
+
+Result Complete(bool is_crc_checked, uint32_t crc, uint32_t& write_count) {
+    HTTPD_DEBUG_ENTRY();
+
+    TimerStop();
+
+    while (Step()) {
+    }
+
+    write_count = 0;
+
+    const auto kIsError = (s_state != State::kProgram);
+    s_state = State::kIdle;
+
+    if (kIsError) {
+        HTTPD_DEBUG_EXIT();
+        return Result::kError;
+    }
+
+    // A corrupt image is not finalised
+    if (is_crc_checked && (crc != s_crc)) {
+        HTTPD_DEBUG_PRINTF("CRC mismatch: %08x != %08x", static_cast<unsigned>(s_crc), static_cast<unsigned>(crc));
+        HTTPD_DEBUG_EXIT();
+        return Result::kCrcMismatch;
+    }
+
+    if (!FlashCodeInstall::Get()->WriteChunkComplete(write_count)) {
+        HTTPD_DEBUG_EXIT();
+        return Result::kError;
+    }
+
+    HTTPD_DEBUG_PRINTF("write_count=%u, crc=%08x", static_cast<unsigned>(write_count), static_cast<unsigned>(s_crc));
+    HTTPD_DEBUG_EXIT();
+    return Result::kOk;
+}
+} // namespace httpd::upload
+
+#endif // CONFIG_HTTPD_ENABLE_UPLOAD
@@ -0,0 +1,63 @@
+/**
+ * @file json_status_profile.cpp
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#if defined(CONFIG_DEBUG_PROFILE)
+
+#include <cstdint>
+
+#include "firmware/debug/debug_profile.h"
+#include "json/json_writer.h"
+
+namespace json::status {
+void Profile(Writer& writer) {
+    using namespace ::debug::profile;
+
+    writer.ObjectBegin();
+    writer.FieldQuoted("clock", TicksPerSecond());
+    writer.ArrayBegin("scopes");
+
+    for (uint32_t index = 0; index < kIds; index++) {
+        const auto& statistics = Get(static_cast<Id>(index));
+
+        writer.ObjectBegin();
+        writer.Field("name", kNames[index]);
+        writer.FieldQuoted("count", statistics.count);
+        writer.FieldQuoted("min", statistics.min);
+        writer.FieldQuoted("avg", (statistics.count != 0) ? static_cast<uint32_t>(statistics.total / statistics.count) : 0);
+        writer.FieldQuoted("max", statistics.max);
+        writer.ArrayBegin("histogram");
+        for (const auto kBucket : statistics.histogram) {
+            writer.Value(kBucket);
+        }
+        writer.ArrayEnd();
+        writer.ObjectEnd();
+    }
+
+    writer.ArrayEnd();
+    writer.ObjectEnd();
+}
+} // namespace json::status
+
+#endif // CONFIG_DEBUG_PROFILE
@@ -0,0 +1,61 @@
+/**
+ * @file json_status_timers.cpp
+ *
+ */
+/* Copyright (C) 2026 by Arjan van Vught mailto:info@gd32-dmx.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#if !defined(CONFIG_HAL_TIMERS_DISABLE_STATISTICS)
+
+#include <cstdint>
+
+#include "softwaretimers.h"
+#include "json/json_writer.h"
+
+namespace json::status {
+void Timers(Writer& writer) {
+    writer.ArrayBegin();
+
+    for (uint32_t index = 0; index < kSoftwareTimersMax; index++) {
+        SoftwareTimerStatus status;
+
+        if (!SoftwareTimerGetStatus(index, status)) {
+            continue;
+        }
+
+        writer.ObjectBegin();
+        writer.FieldQuoted("handle", static_cast<uint32_t>(status.handle));
+        writer.FieldQuoted("interval", status.interval_millis);
+        writer.FieldQuoted("fired", status.fired);
+        writer.FieldQuoted("late_max", status.lateness_max);
+        writer.ArrayBegin("lateness");
+        for (const auto kBucket : status.lateness) {
+            writer.Value(kBucket);
+        }
+        writer.ArrayEnd();
+        writer.ObjectEnd();
+    }
+
+    writer.ArrayEnd();
+}
+} // namespace json::status
+
+#endif // !CONFIG_HAL_TIMERS_DISABLE_STATISTICS
@@ -72,6 +72,13 @@ bool TFTPFileServer::FileCreate(const char* file_name, tftp::Mode mode) {
         return false;
     }
 
+    const auto kTransferSize = GetTransferSize();
+
+    if (kTransferSize > size_) {
+        TFTP_DEBUG_EXIT();
+        return false;
+    }
+
     Display::Get()->TextStatus("TFTP Started", ansi::Colours::Colour::kGreen);
 
     m_nFileSize = 0;
@@ -85,6 +92,9 @@ bool TFTPFileServer::FileClose() {
 
     m_bDone = true;
 
+    [[maybe_unused]] const auto& statistics = GetStatistics();
+    TFTP_DEBUG_PRINTF("%u bytes, %u blocks, %u duplicates, %u ms", static_cast<unsigned>(statistics.bytes), static_cast<unsigned>(statistics.blocks), static_cast<unsigned>(statistics.duplicates), static_cast<unsigned>(statistics.millis));
+
     Display::Get()->TextStatus("TFTP Ended", ansi::Colours::Colour::kGreen);
 
     TFTP_DEBUG_EXIT();
@@ -98,29 +108,27 @@ size_t TFTPFileServer::FileRead([[maybe_unused]] void* buffer, [[maybe_unused]]
     return 0;
 }
 
-size_t TFTPFileServer::FileWrite(const void* buffer, size_t count, unsigned block_number) {
-    TFTP_DEBUG_PRINTF("buffer=%p, count=%d, block_number=%d (%u)", buffer, static_cast<unsigned>(count), static_cast<unsigned>(block_number), static_cast<unsigned>(size_ / 512));
+size_t TFTPFileServer::FileWrite(const void* buffer, size_t count, [[maybe_unused]] unsigned block_number) {
+    TFTP_DEBUG_PRINTF("buffer=%p, count=%d, block_number=%d", buffer, static_cast<unsigned>(count), static_cast<unsigned>(block_number));
+
+    // The daemon only passes blocks in sequence, duplicates are filtered
+    const auto kOffset = m_nFileSize;
 
-    if (block_number > (size_ / 512)) {
+    if ((kOffset + count) > size_) {
         m_nFileSize = 0;
         return 0;
     }
 
-    assert(block_number != 0);
-
-    if (block_number == 1) {
+    if (kOffset == 0) {
         if (!tftpfileserver::is_valid(buffer)) {
             return 0;
         }
     }
 
-    const auto kOffset = (block_number - 1) * 512U;
-
-    assert((kOffset + count) <= size_);
-
+    // The flash is only written on exit, after a complete transfer
     memcpy(&buffer_[kOffset], buffer, count);
 
-    m_nFileSize += count; // FIXME BUG When in retry ?
+    m_nFileSize += static_cast<uint32_t>(count);
 
     Display::Get()->Progress();
 
@@ -31,7 +31,9 @@
 #pragma GCC optimize("O2")
 #endif
 
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <cassert>
 
 #include "showfileprotocol.h"
@@ -43,6 +45,79 @@
 namespace showfile {
 inline constexpr uint32_t kFileNameLength = sizeof(SHOWFILE_PREFIX "NN" SHOWFILE_SUFFIX) - 1U;
 inline constexpr int32_t kFileMaxNumber = 99;
+
+/*
+ * Recorder: the record hooks only copy the universe into a staging ring.
+ * ShowFileRun drains the ring, skips universes that did not change since
+ * they were last written, formats the text and writes it in large chunks.
+ */
+namespace record {
+/*
+ * Universes tracked for skipping unchanged data, each keeps a copy of the data last written.
+ * The ring holds the packets received while the super loop is blocked in a file write.
+ */
+inline constexpr uint32_t kRecordUniverses =
+#if defined(CONFIG_SHOWFILE_RECORD_UNIVERSES)
+    CONFIG_SHOWFILE_RECORD_UNIVERSES;
+#else
+    4;
+#endif
+
+inline constexpr uint32_t kStallMillis =
+#if defined(CONFIG_SHOWFILE_RECORD_STALL_MILLIS)
+    CONFIG_SHOWFILE_RECORD_STALL_MILLIS;
+#else
+    25;
+#endif
+
+inline constexpr uint32_t kPacketsPerSecond = 44; ///< Maximum DMX refresh rate, per universe
+
+constexpr uint32_t RoundUpPowerOf2(uint32_t value) {
+    uint32_t power = 1;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+}
+
+inline constexpr uint32_t kEntries =
+#if defined(CONFIG_SHOWFILE_RECORD_ENTRIES)
+    CONFIG_SHOWFILE_RECORD_ENTRIES;
+#else
+    RoundUpPowerOf2(1U + (kRecordUniverses * kPacketsPerSecond * kStallMillis) / 1000U);
+#endif
+static_assert((kEntries & (kEntries - 1)) == 0, "kEntries must be a power of 2");
+
+inline constexpr uint32_t kBatchSize =
+#if defined(CONFIG_SHOWFILE_RECORD_BATCH_SIZE)
+    CONFIG_SHOWFILE_RECORD_BATCH_SIZE;
+#else
+    2304;
+#endif
+
+inline constexpr uint32_t kFlushMillis = 1000;    ///< A batch is written at the latest this time after its first line
+inline constexpr uint32_t kLineMax = 11 + 6 + (512 * 4); ///< Delay line, universe and 512 values
+static_assert(kBatchSize >= kLineMax);
+
+struct Entry {
+    uint32_t millis;
+    uint16_t universe;
+    uint16_t length;
+    uint8_t data[512];
+};
+
+struct Last {
+    uint16_t universe;
+    uint16_t length;
+    uint8_t data[512]; ///< The data last written
+};
+
+struct Statistics {
+    uint32_t written;   ///< Universes written to the file
+    uint32_t unchanged; ///< Universes skipped, same data as last written
+    uint32_t overrun;   ///< Universes dropped, staging ring was full
+};
+} // namespace record
 } // namespace showfile
 
 class ShowFileFormat : ShowFileProtocol {
@@ -80,6 +155,12 @@ class ShowFileFormat : ShowFileProtocol {
     void ShowFileStop() {
         SHOWFILE_DEBUG_ENTRY();
 
+        if ((m_OlaState == OlaState::RECORD_FIRST) || (m_OlaState == OlaState::RECORDING)) {
+            RecordRun();
+            RecordFlush();
+            m_OlaState = OlaState::IDLE;
+        }
+
         SHOWFILE_DEBUG_EXIT();
     }
 
@@ -101,6 +182,11 @@ class ShowFileFormat : ShowFileProtocol {
 #ifdef DEBUG_SHOWFILE
             perror("fputs");
 #endif
+            record_head_ = 0;
+            record_tail_ = 0;
+            record_batch_length_ = 0;
+            record_last_count_ = 0;
+            memset(&record_statistics_, 0, sizeof(record_statistics_));
             m_OlaState = OlaState::RECORD_FIRST;
         } else {
             m_OlaState = OlaState::IDLE;
@@ -119,6 +205,8 @@ class ShowFileFormat : ShowFileProtocol {
     void ShowFileRun(const bool doRun) {
         if (doRun) {
             Run();
+        } else if ((m_OlaState == OlaState::RECORD_FIRST) || (m_OlaState == OlaState::RECORDING)) {
+            RecordRun();
         }
 
         ShowFileProtocol::Run();
@@ -126,43 +214,30 @@ class ShowFileFormat : ShowFileProtocol {
 
     void DoRunCleanupProcess(bool do_run) { ShowFileProtocol::DoRunCleanupProcess(do_run); }
 
+    /*
+     * Called from the record hooks, while handling the received packet.
+     */
     void ShowfileWrite(const uint8_t* pDmxData, uint32_t size, uint32_t universe, uint32_t millis) {
-        if (m_OlaState == OlaState::RECORD_FIRST) {
-            m_OlaState = OlaState::RECORDING;
-        } else {
-            auto* p = m_buffer;
-            p += FastItoaUniverse(millis - m_nLastMillis, p);
-            *p++ = '\n';
-            *p = '\0';
-            fputs(m_buffer, m_pShowFile);
-#ifdef DEBUG_SHOWFILE
-            perror("fputs");
-            printf("[%s]", m_buffer);
-#endif
+        if ((record_head_ - record_tail_) == showfile::record::kEntries) {
+            record_statistics_.overrun++;
+            return;
         }
 
-        m_nLastMillis = millis;
-
-        auto* p = m_buffer;
-
-        p += FastItoaUniverse(universe & 0xFFFF, p);
-        *p++ = ' ';
-
-        for (uint32_t index = 0; index < size; index++) {
-            p += FastItoaDmx(pDmxData[index] & 0xFF, p);
-            *p++ = ',';
+        if (size > sizeof(showfile::record::Entry::data)) {
+            size = sizeof(showfile::record::Entry::data);
         }
 
-        *--p = '\n';
-        *++p = '\0';
+        auto& entry = record_ring_[record_head_ & (showfile::record::kEntries - 1)];
+        entry.millis = millis;
+        entry.universe = static_cast<uint16_t>(universe);
+        entry.length = static_cast<uint16_t>(size);
+        memcpy(entry.data, pDmxData, size);
 
-        fputs(m_buffer, m_pShowFile);
-#ifdef DEBUG_SHOWFILE
-        perror("fputs");
-        printf("[%s]", m_buffer);
-#endif
+        record_head_++;
     }
 
+    const showfile::record::Statistics& GetRecordStatistics() const { return record_statistics_; }
+
     void BlackOut() {
 #if defined(CONFIG_SHOWFILE_ENABLE_MASTER)
         ShowFileProtocol::DmxBlackout();
@@ -181,6 +256,10 @@ class ShowFileFormat : ShowFileProtocol {
 
    private:
     void Run();
+    void RecordRun();
+    void RecordFlush();
+    bool RecordIsChanged(const showfile::record::Entry& entry);
+    uint32_t RecordFormat(const showfile::record::Entry& entry, char* pDestination);
     /*
      * Using a lookup table to convert binary numbers from 0 to 99
      * into ascii characters as described by Andrei Alexandrescu in
@@ -288,6 +367,16 @@ class ShowFileFormat : ShowFileProtocol {
     uint16_t universe_{0};
     uint8_t dmx_data_[512];
 
+    showfile::record::Entry record_ring_[showfile::record::kEntries];
+    uint32_t record_head_{0}; ///< Free running, next entry to fill
+    uint32_t record_tail_{0}; ///< Free running, next entry to write
+    char record_batch_[showfile::record::kBatchSize];
+    uint32_t record_batch_length_{0};
+    uint32_t record_batch_millis_{0}; ///< When the first line was put in the batch
+    showfile::record::Last record_last_[showfile::record::kRecordUniverses];
+    uint32_t record_last_count_{0};
+    showfile::record::Statistics record_statistics_{};
+
     static ShowFileFormat* s_this;
 };
 
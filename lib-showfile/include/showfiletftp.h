@@ -58,6 +58,16 @@ class ShowFileTFTP final : public TFTPDaemon {
 
     size_t FileWrite(const void* buffer, size_t count, [[maybe_unused]] unsigned block_number) override { return fwrite(buffer, 1, count, file_); }
 
+    size_t FileSize() override {
+        const auto kPosition = ftell(file_);
+        if ((kPosition < 0) || (fseek(file_, 0, SEEK_END) != 0)) {
+            return 0;
+        }
+        const auto kSize = ftell(file_);
+        fseek(file_, kPosition, SEEK_SET);
+        return kSize < 0 ? 0 : static_cast<size_t>(kSize);
+    }
+
     void Exit() override;
 
    private:
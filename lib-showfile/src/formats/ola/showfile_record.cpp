@@ -29,7 +29,120 @@
 #endif
 
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+
 #include "formats/showfileformatola.h"
+#include "timing.h"
+
+namespace {
+uint32_t Utoa(uint32_t nValue, char *pDestination) {
+	char digits[10];
+	uint32_t n = 0;
+	do {
+		digits[n++] = '0' + static_cast<char>(nValue % 10U);
+		nValue /= 10U;
+	} while (nValue != 0);
+
+	for (uint32_t i = 0; i < n; i++) {
+		pDestination[i] = digits[n - 1 - i];
+	}
+
+	return n;
+}
+}  // namespace
+
+/*
+ * The data last written is kept per universe.
+ * When more than kRecordUniverses universes are recorded, the oldest entry
+ * is reused and that universe is written again.
+ */
+bool ShowFileFormat::RecordIsChanged(const showfile::record::Entry& entry) {
+	const auto kCount = (record_last_count_ < showfile::record::kRecordUniverses) ? record_last_count_ : showfile::record::kRecordUniverses;
+
+	for (uint32_t i = 0; i < kCount; i++) {
+		auto& last = record_last_[i];
+		if (last.universe == entry.universe) {
+			if ((last.length == entry.length) && (memcmp(last.data, entry.data, entry.length) == 0)) {
+				return false;
+			}
+			last.length = entry.length;
+			memcpy(last.data, entry.data, entry.length);
+			return true;
+		}
+	}
+
+	auto& last = record_last_[record_last_count_ % showfile::record::kRecordUniverses];
+	last.universe = entry.universe;
+	last.length = entry.length;
+	memcpy(last.data, entry.data, entry.length);
+	record_last_count_++;
+
+	return true;
+}
+
+uint32_t ShowFileFormat::RecordFormat(const showfile::record::Entry& entry, char *pDestination) {
+	auto *p = pDestination;
+
+	if (m_OlaState == OlaState::RECORD_FIRST) {
+		m_OlaState = OlaState::RECORDING;
+	} else {
+		p += Utoa(entry.millis - m_nLastMillis, p);
+		*p++ = '\n';
+	}
+
+	m_nLastMillis = entry.millis;
+
+	p += FastItoaUniverse(entry.universe, p);
+	*p++ = ' ';
+
+	for (uint32_t index = 0; index < entry.length; index++) {
+		p += FastItoaDmx(entry.data[index], p);
+		*p++ = ',';
+	}
+
+	*--p = '\n';
+	p++;
+
+	return static_cast<uint32_t>(p - pDestination);
+}
+
+void ShowFileFormat::RecordRun() {
+	while (record_tail_ != record_head_) {
+		const auto& entry = record_ring_[record_tail_ & (showfile::record::kEntries - 1)];
+
+		if (RecordIsChanged(entry)) {
+			if ((record_batch_length_ + showfile::record::kLineMax) > sizeof(record_batch_)) {
+				RecordFlush();
+			}
+
+			if (record_batch_length_ == 0) {
+				record_batch_millis_ = timing::Millis();
+			}
+
+			record_batch_length_ += RecordFormat(entry, &record_batch_[record_batch_length_]);
+			record_statistics_.written++;
+		} else {
+			record_statistics_.unchanged++;
+		}
+
+		record_tail_++;
+	}
+
+	if ((record_batch_length_ != 0) && ((timing::Millis() - record_batch_millis_) >= showfile::record::kFlushMillis)) {
+		RecordFlush();
+	}
+}
+
+void ShowFileFormat::RecordFlush() {
+	if (record_batch_length_ != 0) {
+		fwrite(record_batch_, 1, record_batch_length_, m_pShowFile);
+#ifdef DEBUG_SHOWFILE
+		perror("fwrite");
+#endif
+		record_batch_length_ = 0;
+	}
+}
 
 #if defined (CONFIG_SHOWFILE_PROTOCOL_NODE_ARTNET)
 #include "artnet.h"
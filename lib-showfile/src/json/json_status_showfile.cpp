@@ -33,11 +33,14 @@ uint32_t ShowFile(char* out_buffer, uint32_t out_buffer_size)
     const auto kStatus = ShowFile::Instance().GetStatus();
     assert(kStatus != ::showfile::Status::kUndefined);
 
+    const auto& kRecord = ShowFile::Instance().GetRecordStatistics();
+
     const auto kLength =
-        static_cast<uint32_t>(snprintf(out_buffer, out_buffer_size, "{\"mode\":\"%s\",\"%s\":\"%u\",\"status\":\"%s\",\"%s\":\"%s\"}",
+        static_cast<uint32_t>(snprintf(out_buffer, out_buffer_size, "{\"mode\":\"%s\",\"%s\":\"%u\",\"status\":\"%s\",\"%s\":\"%s\",\"record\":{\"written\":\"%u\",\"unchanged\":\"%u\",\"overrun\":\"%u\"}}",
         ShowFile::Instance().GetMode() == ::showfile::Mode::kRecorder ? "Recorder" : "Player", ShowFileParamsConst::kShow.name,
         static_cast<unsigned int>(ShowFile::Instance().GetShowFileCurrent()), ::showfile::kStatus[static_cast<int>(kStatus)],
-        ShowFileParamsConst::kOptionLoop.name, ShowFile::Instance().GetDoLoop() ? "1" : "0"));
+        ShowFileParamsConst::kOptionLoop.name, ShowFile::Instance().GetDoLoop() ? "1" : "0",
+        static_cast<unsigned int>(kRecord.written), static_cast<unsigned int>(kRecord.unchanged), static_cast<unsigned int>(kRecord.overrun)));
     return kLength;
 }
 }  // namespace json::status
@@ -41,9 +41,35 @@ using TimerCallbackFunction_t = void (*)(TimerHandle_t);
 inline constexpr TimerHandle_t kTimerIdNone = -1;
 
 TimerHandle_t SoftwareTimerAdd(uint32_t interval_millis,  TimerCallbackFunction_t k_callback);
+/**
+ * The timer is deleted after the callback has returned.
+ */
+TimerHandle_t SoftwareTimerAddOneShot(uint32_t delay_millis, TimerCallbackFunction_t k_callback);
 bool SoftwareTimerDelete(TimerHandle_t& handle);
 bool SoftwareTimerChange(TimerHandle_t handle, uint32_t interval_millis);
 
 void SoftwareTimerRun();
 
+#if !defined(CONFIG_HAL_TIMERS_DISABLE_STATISTICS)
+/*
+ * Lateness is the time between the expire time and the callback, in milliseconds.
+ * Bucket 0 counts 0 ms, bucket n counts [2^(n-1), 2^n) ms, the last bucket counts the rest.
+ */
+inline constexpr uint32_t kSoftwareTimerLatenessBuckets = 8;
+
+struct SoftwareTimerStatus {
+    TimerHandle_t handle;
+    uint32_t interval_millis;
+    uint32_t fired;
+    uint32_t lateness_max;
+    uint32_t lateness[kSoftwareTimerLatenessBuckets];
+};
+
+/**
+ * @param index 0 .. kSoftwareTimersMax - 1
+ * @return false when there is no timer at index
+ */
+bool SoftwareTimerGetStatus(uint32_t index, SoftwareTimerStatus& status);
+#endif
+
 #endif  // SUPERLOOP_SOFTWARETIMERS_H_
@@ -57,6 +57,14 @@
     } while (false)
 #endif
 
+/*
+ * The active timers are kept in a binary min-heap ordered on expire time, so
+ * SoftwareTimerRun only looks at the top to find the expired timers. All
+ * expired timers are fired in the same call.
+ *
+ * A handle is the slot index in the low 8 bits and a generation above it.
+ * A stale handle (timer deleted, slot reused) therefore never matches.
+ */
 namespace {
 void Error(const char* func, const char* string) {
     printf("%s%s: %s%s\n", ansi::Colours::Fg::kRed, func, string, ansi::Colours::Fg::kDefault);
@@ -66,23 +74,180 @@ void Error(const char* func, const char* string, TimerHandle_t handle) {
     printf("%s%s: %s -> %d%s\n", ansi::Colours::Fg::kRed, func, string, static_cast<int>(handle), ansi::Colours::Fg::kDefault);
 }
 
+static_assert(kSoftwareTimersMax <= 256, "The slot index must fit in 8 bits");
+
+constexpr uint32_t kSlotBits = 8;
+constexpr uint32_t kSlotMask = (1U << kSlotBits) - 1U;
+constexpr uint32_t kGenerationMask = (1U << (31U - kSlotBits)) - 1U; ///< Keeps the handle non-negative
+constexpr uint32_t kNotInHeap = UINT32_MAX;
+
 struct Timer {
     uint32_t expire_time;                      ///< Absolute expire time in milliseconds (wrap-around safe).
     uint32_t interval_millis;                  ///< Period in milliseconds
-    int32_t id;                                ///< Opaque handle returned to the caller.
+    int32_t id;                                ///< Opaque handle returned to the caller, kTimerIdNone when the slot is free.
+    uint32_t heap_index;                       ///< Position in s_heap, kNotInHeap while firing.
     TimerCallbackFunction_t callback_function; ///< Callback invoked on expiry; must be non-null.
+    bool is_one_shot;
+#if !defined(CONFIG_HAL_TIMERS_DISABLE_STATISTICS)
+    uint32_t fired;
+    uint32_t lateness_max;
+    uint32_t lateness[kSoftwareTimerLatenessBuckets];
+#endif
 };
 
 Timer s_timers[kSoftwareTimersMax]; ///< Timer storage pool.
-uint32_t s_timers_count = 0;        ///< Number of active timers (0..hal::SOFTWARE_TIMERS_MAX).
-int32_t s_next_id = 0;              ///< Monotonically increasing ID source (may wrap, see notes).
-uint32_t s_timer_current = 0;       ///< bRound-robin cursor for SoftwareTimerRun().
+uint8_t s_heap[kSoftwareTimersMax]; ///< Slot indexes, min-heap on expire_time.
+uint32_t s_heap_count = 0;          ///< Number of timers in the heap.
+uint8_t s_free[kSoftwareTimersMax]; ///< Stack of free slot indexes.
+uint32_t s_free_count = 0;
+uint32_t s_generation = 0;
+bool s_is_initialized = false;
+
+void Init() {
+    for (uint32_t i = 0; i < kSoftwareTimersMax; i++) {
+        s_timers[i].id = kTimerIdNone;
+        s_free[i] = static_cast<uint8_t>(kSoftwareTimersMax - 1U - i);
+    }
+
+    s_free_count = kSoftwareTimersMax;
+    s_is_initialized = true;
+}
+
+inline bool IsBefore(uint32_t slot_a, uint32_t slot_b) {
+    return static_cast<int32_t>(s_timers[slot_a].expire_time - s_timers[slot_b].expire_time) < 0;
+}
+
+inline void HeapSet(uint32_t index, uint32_t slot) {
+    s_heap[index] = static_cast<uint8_t>(slot);
+    s_timers[slot].heap_index = index;
+}
+
+void HeapUp(uint32_t index) {
+    const auto kSlot = s_heap[index];
+
+    while (index != 0) {
+        const auto kParent = (index - 1U) / 2U;
+        if (!IsBefore(kSlot, s_heap[kParent])) {
+            break;
+        }
+        HeapSet(index, s_heap[kParent]);
+        index = kParent;
+    }
+
+    HeapSet(index, kSlot);
+}
+
+void HeapDown(uint32_t index) {
+    const auto kSlot = s_heap[index];
+
+    while (true) {
+        auto child = 2U * index + 1U;
+        if (child >= s_heap_count) {
+            break;
+        }
+        if (((child + 1U) < s_heap_count) && IsBefore(s_heap[child + 1U], s_heap[child])) {
+            child++;
+        }
+        if (!IsBefore(s_heap[child], kSlot)) {
+            break;
+        }
+        HeapSet(index, s_heap[child]);
+        index = child;
+    }
+
+    HeapSet(index, kSlot);
+}
+
+void HeapInsert(uint32_t slot) {
+    HeapSet(s_heap_count++, slot);
+    HeapUp(s_timers[slot].heap_index);
+}
+
+void HeapRemove(uint32_t slot) {
+    const auto kIndex = s_timers[slot].heap_index;
+    s_timers[slot].heap_index = kNotInHeap;
+
+    if (--s_heap_count == kIndex) {
+        return;
+    }
+
+    HeapSet(kIndex, s_heap[s_heap_count]);
+    HeapUp(kIndex);
+    HeapDown(s_timers[s_heap[kIndex]].heap_index);
+}
+
+/*
+ * Returns the slot for a valid handle, kSoftwareTimersMax otherwise
+ */
+inline uint32_t Find(TimerHandle_t handle) {
+    if (handle < 0) {
+        return kSoftwareTimersMax;
+    }
+
+    const auto kSlot = static_cast<uint32_t>(handle) & kSlotMask;
+
+    if ((kSlot >= kSoftwareTimersMax) || (s_timers[kSlot].id != handle)) {
+        return kSoftwareTimersMax;
+    }
+
+    return kSlot;
+}
+
+void Free(uint32_t slot) {
+    s_timers[slot].id = kTimerIdNone;
+    s_free[s_free_count++] = static_cast<uint8_t>(slot);
+}
+
+TimerHandle_t Add(const char* func, uint32_t interval_millis, TimerCallbackFunction_t callback_function, bool is_one_shot) {
+    if (!s_is_initialized) [[unlikely]] {
+        Init();
+    }
+
+    if (s_free_count == 0) {
+        Error(func, "Max timer limit reached");
+        return kTimerIdNone;
+    }
+
+    const auto kSlot = s_free[--s_free_count];
+    s_generation = (s_generation + 1U) & kGenerationMask;
+
+    auto& timer = s_timers[kSlot];
+
+    timer = Timer{};
+    timer.expire_time = timing::Millis() + interval_millis;
+    timer.interval_millis = interval_millis;
+    timer.id = static_cast<TimerHandle_t>((s_generation << kSlotBits) | kSlot);
+    timer.callback_function = callback_function;
+    timer.is_one_shot = is_one_shot;
+
+    HeapInsert(kSlot);
+
+    return timer.id;
+}
+
+#if !defined(CONFIG_HAL_TIMERS_DISABLE_STATISTICS)
+void UpdateStatistics(Timer& timer, uint32_t lateness) {
+    timer.fired++;
+
+    if (lateness > timer.lateness_max) {
+        timer.lateness_max = lateness;
+    }
+
+    auto bucket = (lateness == 0) ? 0U : 32U - static_cast<uint32_t>(__builtin_clz(lateness));
+
+    if (bucket >= kSoftwareTimerLatenessBuckets) {
+        bucket = kSoftwareTimerLatenessBuckets - 1;
+    }
+
+    timer.lateness[bucket]++;
+}
+#endif
 } // namespace
 
 /**
  * @brief Create and start a periodic software timer.
  *
- * @param interval_millis  Period in milliseconds.
+ * @param interval_millis  Period in milliseconds. 0 runs the callback on each SoftwareTimerRun().
  * @param kCallbackFunction Callback function. Must be non-null.
  * @return TimerHandle_t    A non-negative handle on success; -1 on failure (pool full or bad args).
  *
@@ -92,27 +257,25 @@ uint32_t s_timer_current = 0;       ///< bRound-robin cursor for SoftwareTimerRu
  */
 TimerHandle_t SoftwareTimerAdd(uint32_t interval_millis, const TimerCallbackFunction_t kCallbackFunction) {
     HAL_TIMERS_DEBUG_ENTRY();
-    HAL_TIMERS_DEBUG_PRINTF("s_timers_count=%u", static_cast<unsigned>(s_timers_count));
 
-    if (s_timers_count >= kSoftwareTimersMax) {
-        Error(__func__, "Max timer limit reached");
-        return -1;
-    }
+    const auto kHandle = Add(__func__, interval_millis, kCallbackFunction, false);
 
-    const auto kCurrentTime = timing::Millis();
-    // TODO (a) Prevent potential overflow when calculating expiration time.
+    HAL_TIMERS_DEBUG_EXIT();
+    return kHandle;
+}
 
-    Timer new_timer = {
-        .expire_time = kCurrentTime + interval_millis,
-        .interval_millis = interval_millis,
-        .id = s_next_id++,
-        .callback_function = kCallbackFunction,
-    };
+/**
+ * @brief Create a software timer that fires once, after delay_millis.
+ *
+ * @note The handle is no longer valid after the callback has returned.
+ */
+TimerHandle_t SoftwareTimerAddOneShot(uint32_t delay_millis, const TimerCallbackFunction_t kCallbackFunction) {
+    HAL_TIMERS_DEBUG_ENTRY();
 
-    s_timers[s_timers_count++] = new_timer;
+    const auto kHandle = Add(__func__, delay_millis, kCallbackFunction, true);
 
     HAL_TIMERS_DEBUG_EXIT();
-    return new_timer.id;
+    return kHandle;
 }
 
 /**
@@ -122,91 +285,135 @@ TimerHandle_t SoftwareTimerAdd(uint32_t interval_millis, const TimerCallbackFunc
  * @return true  If a timer with the given handle was found and removed.
  * @return false Otherwise.
  *
- * @note Deletion is O(1): the removed slot is replaced with the last active timer.
- *       This changes the order of timers.
+ * @note A timer may delete itself, or any other timer, from its callback.
  */
 bool SoftwareTimerDelete(TimerHandle_t& handle) {
     HAL_TIMERS_DEBUG_ENTRY();
-    HAL_TIMERS_DEBUG_PRINTF("s_timers_count=%u", static_cast<unsigned>(s_timers_count));
-
-    for (uint32_t i = 0; i < s_timers_count; ++i) {
-        if (s_timers[i].id == handle) {
-            // Swap with the last timer to efficiently remove the current timer
-            s_timers[i] = s_timers[s_timers_count - 1];
-            --s_timers_count;
-            // Keep the round-robin cursor within bounds.
-            if (s_timer_current >= s_timers_count) {
-                s_timer_current = 0;
-            }
-
-            handle = -1;
-
-            HAL_TIMERS_DEBUG_ENTRY();
-            return true;
-        }
+
+    const auto kSlot = Find(handle);
+
+    if (kSlot == kSoftwareTimersMax) {
+        Error(__func__, "Timer not found", handle);
+        HAL_TIMERS_DEBUG_EXIT();
+        return false;
+    }
+
+    if (s_timers[kSlot].heap_index != kNotInHeap) {
+        HeapRemove(kSlot);
     }
 
-    Error(__func__, "Timer not found", handle);
+    Free(kSlot);
+    handle = kTimerIdNone;
 
     HAL_TIMERS_DEBUG_EXIT();
-    return false;
+    return true;
 }
 
 /**
  * @brief Change a timer’s period and restart its countdown from now.
  *
  * @param id              Timer handle.
- * @param interval_millis New period in milliseconds (0 => one-shot).
+ * @param interval_millis New period in milliseconds.
  * @return true  On success.
  * @return false If the handle was not found.
  */
 bool SoftwareTimerChange(TimerHandle_t handle, uint32_t interval_millis) {
-    for (uint32_t i = 0; i < s_timers_count; ++i) {
-        if (s_timers[i].id == handle) {
-            const auto kCurrentTime = timing::Millis();
-            s_timers[i].expire_time = kCurrentTime + interval_millis;
-            s_timers[i].interval_millis = interval_millis;
-            return true;
-        }
+    const auto kSlot = Find(handle);
+
+    if (kSlot == kSoftwareTimersMax) {
+        Error(__func__, "Timer not found");
+        return false;
     }
 
-    Error(__func__, "Timer not found");
+    auto& timer = s_timers[kSlot];
+    timer.expire_time = timing::Millis() + interval_millis;
+    timer.interval_millis = interval_millis;
 
-    return false;
+    // While firing, the timer is out of the heap and SoftwareTimerRun reinserts it
+    if (timer.heap_index != kNotInHeap) {
+        HeapRemove(kSlot);
+        HeapInsert(kSlot);
+    }
+
+    return true;
 }
 
 /**
- * @brief Service one timer slot.
+ * @brief Fire all expired timers.
  *
- * If the current slot has expired, its callback is invoked exactly once. The
- * timer is then rescheduled if it is periodic.
- *
- * @note This function is intentionally O(1) per invocation.
- * @note If callbacks delete or add timers, this remains safe due to the
- *       swap-delete approach and the post-callback cursor normalization.
+ * The expired timers are first taken out of the heap, then fired. A timer
+ * is therefore fired at most once per call, also with a 0 ms interval.
+ * A periodic timer is rescheduled from now, to avoid pile-ups after delays.
  */
 void SoftwareTimerRun() {
-    if (s_timers_count == 0) [[unlikely]] {
+    if (s_heap_count == 0) [[unlikely]] {
         return;
     }
 
     const uint32_t kNow = timing::Millis();
-    Timer& timer = s_timers[s_timer_current];
 
-    if (static_cast<int32_t>(kNow - timer.expire_time) >= 0) [[unlikely]] {
-        const int32_t kId = timer.id;
-        const uint32_t kInterval = timer.interval_millis;
-        auto callback_function = timer.callback_function;
+    if (static_cast<int32_t>(kNow - s_timers[s_heap[0]].expire_time) < 0) [[likely]] {
+        return;
+    }
 
-        callback_function(kId);
+    TimerHandle_t expired[kSoftwareTimersMax];
+    uint32_t expired_count = 0;
 
-        // reschedule from NOW to avoid pile-ups after delays
-        s_timers[s_timer_current].expire_time = kNow + kInterval;
+    while ((s_heap_count != 0) && (static_cast<int32_t>(kNow - s_timers[s_heap[0]].expire_time) >= 0)) {
+        const auto kSlot = s_heap[0];
+        HeapRemove(kSlot);
+        expired[expired_count++] = s_timers[kSlot].id;
     }
 
-    // Advance round-robin cursor (bounded next call).
-    ++s_timer_current;
-    if (s_timer_current >= s_timers_count) {
-        s_timer_current = 0;
+    for (uint32_t i = 0; i < expired_count; i++) {
+        const auto kHandle = expired[i];
+        const auto kSlot = Find(kHandle);
+
+        // Deleted by an earlier callback
+        if (kSlot == kSoftwareTimersMax) {
+            continue;
+        }
+
+        auto& timer = s_timers[kSlot];
+
+#if !defined(CONFIG_HAL_TIMERS_DISABLE_STATISTICS)
+        UpdateStatistics(timer, kNow - timer.expire_time);
+#endif
+
+        timer.callback_function(kHandle);
+
+        // The callback may have deleted or changed the timer
+        if ((timer.id != kHandle) || (timer.heap_index != kNotInHeap)) {
+            continue;
+        }
+
+        if (timer.is_one_shot) {
+            Free(kSlot);
+            continue;
+        }
+
+        timer.expire_time = kNow + timer.interval_millis;
+        HeapInsert(kSlot);
+    }
+}
+
+#if !defined(CONFIG_HAL_TIMERS_DISABLE_STATISTICS)
+bool SoftwareTimerGetStatus(uint32_t index, SoftwareTimerStatus& status) {
+    if ((index >= kSoftwareTimersMax) || !s_is_initialized || (s_timers[index].id == kTimerIdNone)) {
+        return false;
     }
+
+    const auto& timer = s_timers[index];
+
+    status.handle = timer.id;
+    status.interval_millis = timer.interval_millis;
+    status.fired = timer.fired;
+    status.lateness_max = timer.lateness_max;
+
+    for (uint32_t i = 0; i < kSoftwareTimerLatenessBuckets; i++) {
+        status.lateness[i] = timer.lateness[i];
+    }
+
+    return true;
 }
+#endif